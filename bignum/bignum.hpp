@@ -1,6 +1,6 @@
 /*
-    Bignum addition and multiplication.
-    Base = 2^32.
+    Bignum addition, multiplication and modular arithmetic.
+    Base = 2^64.
     Ivan Rybin 2019.
 */
 
@@ -10,277 +10,1551 @@
 #include <string>
 #include <vector>
 #include <utility>
-#include <sstream>
 #include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <functional>
+
+template <typename T, size_t N>
+class small_vector {                                                            // small_vector
+    // the first N elements live inside the object, the heap is used only above that
+public:
+    small_vector() = default;
+
+    small_vector(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+    }
+
+    small_vector(const small_vector& other) {
+        assign(other.begin(), other.end());
+    }
+
+    small_vector(small_vector&& other) noexcept {
+        steal(other);
+    }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        if (other.ptr_ == other.local_) {                                       // inline source, keep own capacity
+            std::copy(other.begin(), other.end(), ptr_);
+            size_       = other.size_;
+            other.size_ = 0;
+            return *this;
+        }
+
+        if (ptr_ != local_) {
+            delete[] ptr_;
+        }
+        steal(other);
+
+        return *this;
+    }
+
+    ~small_vector() {
+        if (ptr_ != local_) {
+            delete[] ptr_;
+        }
+    }
+
+    size_t   size()     const { return size_;     }
+    size_t   capacity() const { return cap_;      }
+    bool     empty()    const { return size_ == 0; }
+
+    T*       data()           { return ptr_; }
+    const T* data()     const { return ptr_; }
+
+    T*       begin()          { return ptr_; }
+    T*       end()            { return ptr_ + size_; }
+    const T* begin()    const { return ptr_; }
+    const T* end()      const { return ptr_ + size_; }
+
+    T&       operator[](size_t i)       { return ptr_[i]; }
+    const T& operator[](size_t i) const { return ptr_[i]; }
+
+    void reserve(size_t n) {
+        if (n <= cap_) {
+            return;
+        }
+
+        size_t cap  = std::max(n, 2 * cap_);
+        T*     heap = new T[cap];
+
+        std::copy(ptr_, ptr_ + size_, heap);
+        if (ptr_ != local_) {
+            delete[] ptr_;
+        }
+
+        ptr_ = heap;
+        cap_ = cap;
+    }
+
+    void resize(size_t n) {                                                     // new elements are zeros
+        reserve(n);
+        if (n > size_) {
+            std::fill(ptr_ + size_, ptr_ + n, T{});
+        }
+        size_ = n;
+    }
+
+    void push_back(const T& value) {
+        reserve(size_ + 1);
+        ptr_[size_++] = value;
+    }
+
+    void assign(size_t n, const T& value) {
+        reserve(n);
+        std::fill(ptr_, ptr_ + n, value);
+        size_ = n;
+    }
+
+    template <typename It, typename = std::enable_if_t<!std::is_integral<It>::value>>
+    void assign(It first, It last) {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        reserve(n);
+        std::copy(first, last, ptr_);
+        size_ = n;
+    }
+
+    void clear() {
+        size_ = 0;
+    }
+
+private:
+    void steal(small_vector& other) noexcept {                                  // steal()
+        // takes the heap buffer of other, inline elements are copied
+        if (other.ptr_ == other.local_) {
+            std::copy(other.begin(), other.end(), local_);
+            ptr_ = local_;
+            cap_ = N;
+        } else {
+            ptr_ = other.ptr_;
+            cap_ = other.cap_;
+
+            other.ptr_ = other.local_;
+            other.cap_ = N;
+        }
+
+        size_       = other.size_;
+        other.size_ = 0;
+    }
+
+    T      local_[N] = {};
+    T*     ptr_      = local_;
+    size_t size_     = 0;
+    size_t cap_      = N;
+};
+
+struct bignum;
+
+template <typename It>
+bignum product(It first, It last, bool parallel = true);
+
+struct bignum {
+    bignum() : big_str(""), 
+               data   ({0}) {}
+
+    bignum(uint32_t decimal) : big_str(""),                                 // bignum(uin32_t)
+                               data   ({decimal}) {}
+
+    bignum(const bignum& another) : big_str(another.big_str),               // bignum(bignum)
+                                    data   (another.data) 	{}
+
+    bignum(bignum&& another) noexcept : big_str(std::move(another.big_str)),  // bignum(bignum&&)
+                                        data   (std::move(another.data)) {
+        another.big_str.clear();
+        another.data.assign(1, 0);                                              // moved-from is zero
+    }
+
+    explicit bignum(const std::string& decimal_str) {                       // bignum(string)
+	    limbs x = from_decimal(decimal_str);
+
+	    if (decimal_str.size() == 1 || decimal_str[0] != '0') {                 // canonical input is the cache
+	        big_str = decimal_str;
+	    }
+	    data.assign(x.begin(), x.end());
+
+	    if (data.empty()) {
+	        data.push_back(0);
+	    }
+	}
+
+    explicit operator bool    () const {                                    // bool
+        return (data.size() > 1 || data[0] != 0) ? true : false;
+    }
+
+    explicit operator uint32_t() const {                                    // uint32_t()
+        return static_cast<uint32_t>(data[0]);                                  // mod 2^32
+    }
+
+    bignum& operator=(uint32_t rhs) {                                       // = uin32_t
+        big_str.clear();
+        data.assign(1, rhs);
+
+        return *this;
+    }
+
+    bignum& operator=(const bignum& rhs) {                                  // = bignum
+        if (this == &rhs) {
+            return *this;
+        }
+
+        this->data    = rhs.data;
+        this->big_str = rhs.big_str;
+
+        return *this;
+    }
+
+    bignum& operator=(bignum&& rhs) noexcept {                              // = bignum&&
+        if (this == &rhs) {
+            return *this;
+        }
+
+        this->data    = std::move(rhs.data);
+        this->big_str = std::move(rhs.big_str);
+
+        rhs.big_str.clear();
+        rhs.data.assign(1, 0);
+
+        return *this;
+    }
+
+    bignum& operator+=(const bignum& rhs) {                                 // += bignum
+        // in place, the limb buffer grows only when the sum gets longer
+        size_t l_size = data.size();
+        size_t r_size = rhs.data.size();
+
+       	if (r_size == 1 && rhs.data[0] == 0) { 
+            return *this; 
+        }
+
+        big_str.clear();
+
+        size_t res_size = std::max(l_size, r_size);
+        data.resize(res_size + 1);                                              // rhs may be *this, sizes are saved
+
+        const limb* r = rhs.data.data();
+        if (l_size >= r_size) {
+            data[res_size] = add(data.data(), data.data(), l_size, r, r_size);
+        } else {
+            data[res_size] = add(data.data(), r, r_size, data.data(), l_size);
+        }
+
+        zero_cleaner(data);
+        return *this;
+    }
+
+    bignum& operator*=(const bignum& rhs) {                                 // *= bignum
+        // the product goes to scratch and is copied back into own buffer
+        size_t l_size = data.size();
+        size_t r_size = rhs.data.size();
+
+        if (r_size == 1 && rhs.data[0] == 1) { 
+            return *this; 
+        }
+
+        big_str.clear();
+
+        if ((l_size == 1 && data[0] == 0) || (r_size == 1 && rhs.data[0] == 0)) {
+            data.assign(1, 0);
+            return *this;
+        }
+
+        scratch product(l_size + r_size);
+
+        mul(product.data(), data.data(), l_size, rhs.data.data(), r_size);
+
+        data.assign(product.buf.begin(), product.buf.end());
+        zero_cleaner(data);
+
+        return *this;
+    }
+
+    const std::string& decimal() {                                          // decimal()
+        // decimal string is built on demand and cached until the next mutation
+        if (big_str.empty()) {
+            big_str = to_string();
+        }
+        return big_str;
+    }
+
+    std::string decimal() const {                                           // decimal() const
+        // never writes the cache, so several threads may print one const bignum at once
+        return big_str.empty() ? to_string() : big_str;
+    }
+
+    std::string to_string() const {                                         // to_string()  
+        // divide and conquer: x = q * 10^(19 * 2^(k-1)) + r, halves printed recursively
+        limbs x = v_slice(data.data(), data.size());
+
+        if (x.empty()) {
+            return "0";
+        }
+
+        decimal_powers& powers = thread_powers();
+
+        size_t k = 0;
+        while (v_compare(powers.power(k), x) <= 0) {
+            ++k;
+        }
+
+        std::string out{};
+        out.reserve(chunk_digits << k);
+
+        print_decimal(out, x, k, 0, powers);
+
+        return out;
+    }
+
+    static void set_threads(unsigned count) {                               // set_threads()
+        // threads one multiplication may use, 1 keeps it on the calling thread
+        thread_limit().store(std::max(count, 1u));
+    }
+
+    static unsigned threads() {                                             // threads()
+        return thread_limit().load();
+    }
+
+    // base 2^64
+    static const int            limb_bits  = 64;
+
+    // multiplication thresholds, in limbs of the shorter operand
+    static const size_t         karatsuba_threshold = 40;
+    static const size_t         toom3_threshold     = 400;
+    static const size_t         ntt_threshold       = 3500;
+    static const size_t         parallel_threshold  = 1000;     // sub-products go to helper threads
+    static const size_t         product_parallel    = 256;      // values in a product subtree for a helper thread
+
+    // decimal conversion: 10^19 chunks, basecase below the thresholds (limbs)
+    static const uint64_t       chunk_base           = 10000000000000000000ull;
+    static const size_t         chunk_digits         = 19;
+    static const size_t         conversion_threshold = 40;
+    static const size_t         inverse_threshold    = 40;
+
+    // friends
+    friend bignum operator+(const bignum& lhs, const bignum& rhs);
+    friend bignum operator*(const bignum& lhs, const bignum& rhs);
+    friend bignum operator/(const bignum& lhs, const bignum& rhs);
+    friend bignum operator%(const bignum& lhs, const bignum& rhs);
+
+    friend std::pair<bignum, bignum> divmod(const bignum& lhs, const bignum& rhs);
+    friend bignum mod    (const bignum& lhs, const bignum& rhs);
+    friend bignum pow_mod(const bignum& base, const bignum& exp, const bignum& m);
+
+    friend std::ostream& operator<<(std::ostream& os, const bignum& rhs);
+    friend std::istream& operator>>(std::istream& is, const bignum& rhs);
+
+    template <size_t Bits>
+    friend struct fixed_bignum;
+
+    friend class bignum_accumulator;
+
+    template <typename It>
+    friend bignum product(It first, It last, bool parallel);
+
+    template <typename It>
+    friend bignum sum(It first, It last);
+
+    // deleted operators
+    bignum&             operator--()                                     = delete;
+    bignum&             operator-=(const bignum& rhs)                    = delete;
+    bignum&             operator- (const bignum& rhs)                    = delete;
+    friend const bignum operator- (const bignum& lhs, const bignum& rhs) = delete;
+
+    private: // -----------------------------------------bignum private ----------------------------------------- //
+
+    // --------------------------------- limb kernels, base 2^64, lowest limb first --------------------------------- //
+
+    using limb  = uint64_t;
+    using dlimb = unsigned __int128;
+    using u128  = unsigned __int128;
+    using limbs = std::vector<limb>;
+
+    static const size_t inline_limbs = 4;
+    using limb_storage = small_vector<limb, inline_limbs>;
+
+    static size_t normalized(const limb* a, size_t n) {                         // normalized()
+        while (n > 0 && a[n - 1] == 0) {
+            --n;
+        }
+        return n;
+    }
+
+    static int compare(const limb* a, size_t an, const limb* b, size_t bn) {    // compare()
+        an = normalized(a, an);
+        bn = normalized(b, bn);
+
+        if (an != bn) {
+            return an < bn ? -1 : 1;
+        }
+        for (size_t i = an; i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static limb add(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {  // add(), an >= bn
+        limb carry = 0;
+        size_t i   = 0;
+
+        for (; i < bn; ++i) {
+            dlimb sum = static_cast<dlimb>(a[i]) + b[i] + carry;
+
+            r[i]  = static_cast<limb>(sum);
+            carry = static_cast<limb>(sum >> limb_bits);
+        }
+        for (; i < an; ++i) {
+            r[i]  = a[i] + carry;
+            carry = r[i] < carry;
+        }
+        return carry;
+    }
+
+    static limb sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {  // sub(), an >= bn
+        limb borrow = 0;
+        size_t i    = 0;
+
+        for (; i < bn; ++i) {
+            dlimb diff = static_cast<dlimb>(a[i]) - b[i] - borrow;
+
+            r[i]   = static_cast<limb>(diff);
+            borrow = static_cast<limb>(diff >> limb_bits) & 1;
+        }
+        for (; i < an; ++i) {
+            limb take = borrow;
+
+            borrow = a[i] < take;
+            r[i]   = a[i] - take;
+        }
+        return borrow;
+    }
+
+    static limb lshift(limb* r, const limb* a, size_t n, unsigned bits) {       // lshift(), 0 < bits < 64
+        limb out = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            limb next = a[i] >> (limb_bits - bits);
+
+            r[i] = (a[i] << bits) | out;
+            out  = next;
+        }
+        return out;
+    }
+
+    static void rshift(limb* r, const limb* a, size_t n, unsigned bits) {       // rshift(), 0 < bits < 64
+        for (size_t i = 0; i < n; ++i) {
+            limb high = (i + 1 < n) ? a[i + 1] << (limb_bits - bits) : 0;
+
+            r[i] = (a[i] >> bits) | high;
+        }
+    }
+
+    static limb mul_1(limb* r, const limb* a, size_t n, limb x, limb carry_in = 0) {   // mul_1()
+        limb carry = carry_in;
+
+        for (size_t i = 0; i < n; ++i) {
+            dlimb t = static_cast<dlimb>(a[i]) * x + carry;
+
+            r[i]  = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> limb_bits);
+        }
+        return carry;
+    }
+
+    static limb addmul_1(limb* r, const limb* a, size_t n, limb x) {            // addmul_1(), r += a * x
+        limb carry = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            dlimb t = static_cast<dlimb>(a[i]) * x + r[i] + carry;
+
+            r[i]  = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> limb_bits);
+        }
+        return carry;
+    }
+
+    static limb submul_1(limb* r, const limb* a, size_t n, limb x) {            // submul_1(), r -= a * x
+        limb carry = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            dlimb t  = static_cast<dlimb>(a[i]) * x + carry;
+            limb  lo = static_cast<limb>(t);
+
+            carry = static_cast<limb>(t >> limb_bits) + (r[i] < lo);
+            r[i] -= lo;
+        }
+        return carry;
+    }
+
+    static limb divrem_1(limb* q, const limb* a, size_t n, limb x) {            // divrem_1()
+        limb rem = 0;
+
+        for (size_t i = n; i-- > 0;) {
+            dlimb t = (static_cast<dlimb>(rem) << limb_bits) | a[i];
+
+            q[i] = static_cast<limb>(t / x);
+            rem  = static_cast<limb>(t % x);
+        }
+        return rem;
+    }
+
+    static void divexact_1(limb* q, const limb* a, size_t n, limb x) {          // divexact_1(), x odd
+        // multiplication by x^-1 mod 2^64 instead of division
+        limb inv = x;
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - x * inv;
+        }
+
+        limb borrow = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            limb s  = a[i] - borrow;
+            limb b0 = a[i] < borrow;
+
+            q[i]   = s * inv;
+            borrow = static_cast<limb>((static_cast<dlimb>(q[i]) * x) >> limb_bits) + b0;
+        }
+    }
+
+    static void mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+        std::fill(r, r + an + bn, 0);                                           // mul_basecase()
+
+        for (size_t i = 0; i < bn; ++i) {
+            r[i + an] = addmul_1(r + i, a, an, b[i]);
+        }
+    }
+
+    static void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {  // mul()
+        // r[0, an + bn) = a * b, r must not overlap the operands
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+
+        if (bn < karatsuba_threshold) {
+            mul_basecase(r, a, an, b, bn);
+
+        } else if (bn >= ntt_threshold) {
+            mul_ntt(r, a, an, b, bn);
+
+        } else if (an >= 2 * bn) {
+            mul_unbalanced(r, a, an, b, bn);
+
+        } else if (bn < toom3_threshold || bn <= 2 * ((an + 2) / 3)) {
+            mul_karatsuba(r, a, an, b, bn);
+
+        } else {
+            mul_toom3(r, a, an, b, bn);
+        }
+    }
+
+    static void mul_unbalanced(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+        // a is cut into bn-limb pieces, each piece product is balanced      // mul_unbalanced()
+        scratch tmp(2 * bn);
+
+        std::fill(r, r + an + bn, 0);
+
+        for (size_t off = 0; off < an; off += bn) {
+            size_t len = std::min(bn, an - off);
+
+            mul(tmp.data(), a + off, len, b, bn);
+            add(r + off, r + off, an + bn - off, tmp.data(), len + bn);
+        }
+    }
+
+    static void mul_karatsuba(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+        // a * b = z2 * B^2h + ((a0 + a1)(b0 + b1) - z0 - z2) * B^h + z0    // mul_karatsuba()
+        size_t h = (an + 1) / 2;
+
+        if (bn <= h) {
+            mul_unbalanced(r, a, an, b, bn);
+            return;
+        }
+
+        const limb* a0 = a;
+        const limb* a1 = a + h;
+        const limb* b0 = b;
+        const limb* b1 = b + h;
+
+        scratch sa(h + 1), sb(h + 1), z1(2 * h + 2);
+
+        sa[h] = add(sa.data(), a0, h, a1, an - h);
+        sb[h] = add(sb.data(), b0, h, b1, bn - h);
+
+        run_tasks(bn >= parallel_threshold,
+                  [&] { mul(r,         a0, h,      b0, h);      },                // z0
+                  [&] { mul(r + 2 * h, a1, an - h, b1, bn - h); },                // z2
+                  [&] { mul(z1.data(), sa.data(), h + 1, sb.data(), h + 1); });
+
+        sub(z1.data(), z1.data(), 2 * h + 2, r,         2 * h);
+        sub(z1.data(), z1.data(), 2 * h + 2, r + 2 * h, an + bn - 2 * h);
+
+        size_t rest = an + bn - h;
+        add(r + h, r + h, rest, z1.data(), std::min(normalized(z1.data(), 2 * h + 2), rest));
+    }
+
+    // value helpers for toom-3, every result is normalized
+    static limbs v_add(const limbs& x, const limbs& y) {                        // v_add()
+        const limbs& u = x.size() >= y.size() ? x : y;
+        const limbs& v = x.size() >= y.size() ? y : x;
+
+        limbs res(u.size() + 1);
+        res[u.size()] = add(res.data(), u.data(), u.size(), v.data(), v.size());
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    static limbs v_sub(const limbs& x, const limbs& y) {                        // v_sub(), x >= y
+        limbs res(x.size());
+        sub(res.data(), x.data(), x.size(), y.data(), y.size());
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    static limbs v_mul(const limbs& x, const limbs& y) {                        // v_mul()
+        if (x.empty() || y.empty()) {
+            return {};
+        }
+        limbs res(x.size() + y.size());
+        mul(res.data(), x.data(), x.size(), y.data(), y.size());
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    static limbs v_mul_1(const limbs& x, limb m) {                              // v_mul_1()
+        limbs res(x.size() + 1);
+        res[x.size()] = mul_1(res.data(), x.data(), x.size(), m);
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    static limbs v_half(const limbs& x) {                                       // v_half(), exact
+        limbs res(x.size());
+        rshift(res.data(), x.data(), x.size(), 1);
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    static limbs v_third(const limbs& x) {                                      // v_third(), exact
+        limbs res(x.size());
+        divexact_1(res.data(), x.data(), x.size(), 3);
+        res.resize(normalized(res.data(), res.size()));
+        return res;
+    }
+
+    // ------------------------------- helper threads for independent sub-products ------------------------------- //
+
+    static std::atomic<unsigned>& thread_limit() {                              // thread_limit()
+        static std::atomic<unsigned> limit{std::max(std::thread::hardware_concurrency(), 1u)};
+        return limit;
+    }
+
+    static std::atomic<unsigned>& busy_helpers() {                              // busy_helpers()
+        static std::atomic<unsigned> busy{0};
+        return busy;
+    }
+
+    static bool acquire_helper() {                                              // acquire_helper()
+        unsigned busy = busy_helpers().load();
+
+        while (busy + 1 < thread_limit().load()) {
+            if (busy_helpers().compare_exchange_weak(busy, busy + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct helper_slot {                        // one helper of the budget, given back however the task ends
+        ~helper_slot() { busy_helpers().fetch_sub(1); }
+    };
+
+    template <typename Task>
+    static void run_guarded(Task& task, std::exception_ptr& error) noexcept {  // run_guarded()
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    template <typename Task>
+    static void start_task(bool helper, std::thread& thread,                    // start_task()
+                           Task& task, std::exception_ptr& error) {
+        // on a helper thread when one was acquired, here otherwise or when no thread can be created
+        if (helper) {
+            try {
+                thread = std::thread([&task, &error] {
+                    helper_slot slot{};
+                    run_guarded(task, error);
+                });
+                return;
+            } catch (...) {
+                busy_helpers().fetch_sub(1);
+            }
+        }
+        run_guarded(task, error);
+    }
+
+    static void finish_tasks(std::thread* threads, std::exception_ptr* errors, size_t count) {  // finish_tasks()
+        // every helper is joined before the first error, in task order, is rethrown
+        for (size_t i = 0; i < count; ++i) {
+            if (threads[i].joinable()) {
+                threads[i].join();
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (errors[i]) {
+                std::rethrow_exception(errors[i]);
+            }
+        }
+    }
+
+    template <typename... Tasks>
+    static void run_tasks(bool parallel, Tasks&&... tasks) {                    // run_tasks()
+        // tasks go to helper threads while the budget allows, the last one and the rest run here
+        const size_t count = sizeof...(Tasks);
+
+        std::thread        helpers[count];
+        std::exception_ptr errors [count];
+        size_t             i = 0;
+
+        auto start = [&](auto& task) {
+            start_task(parallel && i + 1 < count && acquire_helper(), helpers[i], task, errors[i]);
+            ++i;
+        };
+        (start(tasks), ...);
+
+        finish_tasks(helpers, errors, count);
+    }
+
+    template <typename Task>
+    static void run_shares(bool parallel, size_t count, const Task& task) {     // run_shares(), task(i) for i < count
+        std::vector<std::thread>           helpers(count);
+        std::vector<std::exception_ptr>    errors (count);
+        std::vector<std::function<void()>> shares {};
+
+        shares.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            shares.emplace_back([&task, i] { task(i); });
+        }
+        for (size_t i = 0; i < count; ++i) {
+            start_task(parallel && i + 1 < count && acquire_helper(), helpers[i], shares[i], errors[i]);
+        }
+
+        finish_tasks(helpers.data(), errors.data(), count);
+    }
+
+    static bignum product_tree(bignum* values, size_t n, bool parallel) {      // product_tree()
+        // halves by count, so the two factors of every multiplication have similar size
+        if (n == 1) {
+            return std::move(values[0]);
+        }
+
+        bignum left{}, right{};
+        size_t half = n / 2;
+
+        run_tasks(parallel && n >= product_parallel,
+                  [&] { left  = product_tree(values,        half,     parallel); },
+                  [&] { right = product_tree(values + half, n - half, parallel); });
+
+        return std::move(left) * right;
+    }
+
+    // ----------------------------- per-thread scratch pool for temporary limb buffers ----------------------------- //
+
+    static const size_t scratch_pool_size  = 32;            // buffers kept per thread
+    static const size_t scratch_keep_limbs = 1 << 20;       // larger buffers go back to the heap
+
+    static std::vector<limbs>& scratch_pool() {                                 // scratch_pool()
+        thread_local std::vector<limbs> pool = [] {
+            std::vector<limbs> init;
+            init.reserve(scratch_pool_size);
+            return init;
+        }();
+        return pool;
+    }
+
+    struct scratch {                                                            // zeroed limbs from the pool
+        // the buffer returns to the pool of the thread that took it, capacity survives reuse
+        explicit scratch(size_t n) {
+            std::vector<limbs>& pool = scratch_pool();
+
+            if (!pool.empty()) {
+                buf = std::move(pool.back());
+                pool.pop_back();
+            }
+            buf.assign(n, 0);
+        }
 
-struct bignum {
-    bignum() : big_str("0"), 
-               data   ({0}) {}
+        ~scratch() {
+            std::vector<limbs>& pool = scratch_pool();
 
-    bignum(uint32_t decimal) : big_str(""),                                 // bignum(uin32_t)
-                               data   ({decimal}) {
-        big_str = this->to_string();
-    }
+            if (pool.size() < scratch_pool_size && buf.capacity() <= scratch_keep_limbs) {
+                pool.push_back(std::move(buf));
+            }
+        }
 
-    bignum(const bignum& another) : big_str(another.big_str),               // bignum(bignum)
-                                    data   (another.data) 	{}
+        scratch(const scratch&)            = delete;
+        scratch& operator=(const scratch&) = delete;
 
-    explicit bignum(const std::string& decimal_str) {                       // bignum(string)
-	    big_str = decimal_str;
-	    recursive_div(decimal_str);
+        limb*       data()                     { return buf.data(); }
+        limb&       operator[](size_t i)       { return buf[i];     }
+        const limb& operator[](size_t i) const { return buf[i];     }
 
-	    zero_cleaner(data);
-	}
+        limbs buf;
+    };
 
-    explicit operator bool    () const {                                    // bool
-        return (data.size() > 1 || data[0] != 0) ? true : false;
+    static limbs v_slice(const limb* a, size_t n) {                             // v_slice()
+        return limbs(a, a + normalized(a, n));
     }
 
-    explicit operator uint32_t() const {                                    // uint32_t()
-        if (data.size() == 1) {
-            return data[0];
+    static void mul_toom3(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+        // evaluation in 0, 1, -1, 2, inf, only the -1 values carry a sign   // mul_toom3()
+        size_t k = (an + 2) / 3;
+
+        limbs a0 = v_slice(a, k), a1 = v_slice(a + k, k), a2 = v_slice(a + 2 * k, an - 2 * k);
+        limbs b0 = v_slice(b, k), b1 = v_slice(b + k, k), b2 = v_slice(b + 2 * k, bn - 2 * k);
+
+        auto minus_one = [](const limbs& x0, const limbs& x1, const limbs& x2, bool& negative) {
+            limbs even = v_add(x0, x2);
+            negative   = compare(even.data(), even.size(), x1.data(), x1.size()) < 0;
+            return negative ? v_sub(x1, even) : v_sub(even, x1);
+        };
+
+        bool  pm_neg = false, qm_neg = false;
+        limbs p1  = v_add(v_add(a0, a1), a2);
+        limbs q1  = v_add(v_add(b0, b1), b2);
+        limbs pm1 = minus_one(a0, a1, a2, pm_neg);
+        limbs qm1 = minus_one(b0, b1, b2, qm_neg);
+        limbs p2  = v_add(a0, v_mul_1(v_add(a1, v_mul_1(a2, 2)), 2));
+        limbs q2  = v_add(b0, v_mul_1(v_add(b1, v_mul_1(b2, 2)), 2));
+
+        limbs c0, r1, rm1, r2, c4;
+
+        run_tasks(bn >= parallel_threshold,
+                  [&] { c0  = v_mul(a0,  b0);  },
+                  [&] { r1  = v_mul(p1,  q1);  },
+                  [&] { rm1 = v_mul(pm1, qm1); },
+                  [&] { r2  = v_mul(p2,  q2);  },
+                  [&] { c4  = v_mul(a2,  b2);  });
+
+        bool neg = pm_neg != qm_neg;
+
+        // c0 + c2 + c4 and c1 + c3 from the values in 1 and -1
+        limbs even = v_half(neg ? v_sub(r1, rm1) : v_add(r1, rm1));
+        limbs odd  = v_half(neg ? v_add(r1, rm1) : v_sub(r1, rm1));
+        limbs c2   = v_sub(v_sub(even, c0), c4);
+
+        // c1 + 4 * c3 from the value in 2
+        limbs t  = v_half(v_sub(v_sub(v_sub(r2, c0), v_mul_1(c2, 4)), v_mul_1(c4, 16)));
+        limbs c3 = v_third(v_sub(t, odd));
+        limbs c1 = v_sub(odd, c3);
+
+        size_t rn = an + bn;
+        std::fill(r, r + rn, 0);
+
+        const limbs* coefs[] = {&c0, &c1, &c2, &c3, &c4};
+        for (size_t i = 0; i < 5; ++i) {
+            if (!coefs[i]->empty()) {
+                add(r + i * k, r + i * k, rn - i * k, coefs[i]->data(), coefs[i]->size());
+            }
+        }
+    }
+
+    // ------------------------- NTT over three primes c * 2^k + 1 < 2^62, CRT recombination ------------------------- //
+
+    struct ntt_prime {
+        uint64_t p;
+        uint64_t g;         // primitive root
+        uint64_t inv;       // p^-1 mod 2^64
+        uint64_t r2;        // 2^128 mod p
+        uint64_t one;       // 2^64  mod p
+
+        ntt_prime(uint64_t p_, uint64_t g_) : p(p_), g(g_), inv(p_) {
+            for (int i = 0; i < 5; ++i) {
+                inv *= 2 - p * inv;
+            }
+            one = static_cast<uint64_t>((static_cast<u128>(1) << 64) % p);
+            r2  = static_cast<uint64_t>(static_cast<u128>(one) * one % p);
+        }
+
+        uint64_t mul(uint64_t a, uint64_t b) const {                            // Montgomery a * b / 2^64
+            u128     t = static_cast<u128>(a) * b;
+            uint64_t q = static_cast<uint64_t>(t) * inv;
+            uint64_t h = static_cast<uint64_t>((static_cast<u128>(q) * p) >> 64);
+            uint64_t x = static_cast<uint64_t>(t >> 64);
+
+            return sub(x, h);
+        }
+
+        // branchless, operands are below p < 2^62 so the sign bit tells the wrap
+        uint64_t add(uint64_t a, uint64_t b) const { return sub(a + b, p); }
+        uint64_t sub(uint64_t a, uint64_t b) const {
+            uint64_t d = a - b;
+            return d + (p & (0 - (d >> 63)));
         }
 
-        uint64_t mod = data[0] + data[1] * bignum::u_base;
+        uint64_t to_mont  (uint64_t a) const { return mul(a, r2); }
+        uint64_t from_mont(uint64_t a) const { return mul(a, 1);  }
 
-        return mod % (bignum::u_base + 1);
+        uint64_t pow(uint64_t a, uint64_t e) const {                            // Montgomery form in and out
+            uint64_t res = one;
+            for (; e != 0; e >>= 1) {
+                if (e & 1) {
+                    res = mul(res, a);
+                }
+                a = mul(a, a);
+            }
+            return res;
+        }
+    };
+
+    static const ntt_prime* ntt_primes() {                                      // ntt_primes()
+        static const ntt_prime primes[3] = {
+            {4179340454199820289ull, 3},                                        // 29 * 2^57 + 1
+            {2485986994308513793ull, 5},                                        // 69 * 2^55 + 1
+            {2053641430080946177ull, 7},                                        // 57 * 2^55 + 1
+        };
+        return primes;
     }
 
-    bignum& operator=(uint32_t rhs) {                                       // = uin32_t
-        big_str = std::to_string(rhs);
-        data.assign(1, rhs);
+    static void ntt(std::vector<uint64_t>& a, bool invert, const ntt_prime& m) {    // ntt()
+        size_t n = a.size();
 
-        return *this;
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+        }
+
+        scratch roots(n / 2);
+
+        for (size_t len = 2; len <= n; len <<= 1) {
+            uint64_t w = m.pow(m.to_mont(m.g), (m.p - 1) / len);
+            if (invert) {
+                w = m.pow(w, m.p - 2);
+            }
+
+            size_t half = len / 2;
+            roots[0] = m.one;
+            for (size_t j = 1; j < half; ++j) {
+                roots[j] = m.mul(roots[j - 1], w);
+            }
+
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    uint64_t u = a[i + j];
+                    uint64_t v = m.mul(a[i + j + half], roots[j]);
+
+                    a[i + j]        = m.add(u, v);
+                    a[i + j + half] = m.sub(u, v);
+                }
+            }
+        }
+
+        if (invert) {
+            uint64_t n_inv = m.pow(m.to_mont(n), m.p - 2);
+            for (auto& x : a) {
+                x = m.mul(x, n_inv);
+            }
+        }
     }
 
-    bignum& operator=(const bignum& rhs) {                                  // = bignum
-        if (this == &rhs) {
-            return *this;
+    static void ntt_convolution(std::vector<uint64_t>& fa,                     // ntt_convolution()
+                                const limb* a, size_t an, const limb* b, size_t bn,
+                                const ntt_prime& m, bool parallel) {
+        // fa holds n zeros on entry and the cyclic product on exit
+        size_t  n = fa.size();
+        scratch fb(n);
+
+        for (size_t i = 0; i < an; ++i) { fa[i] = m.to_mont(a[i]); }
+        for (size_t i = 0; i < bn; ++i) { fb[i] = m.to_mont(b[i]); }
+
+        run_tasks(parallel,
+                  [&] { ntt(fa, false, m); },
+                  [&] { ntt(fb.buf, false, m); });
+
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = m.mul(fa[i], fb[i]);
         }
 
-        this->data    = rhs.data;
-        this->big_str = rhs.big_str;
+        ntt(fa, true, m);
 
-        return *this;
+        for (auto& x : fa) {
+            x = m.from_mont(x);
+        }
     }
 
-    bignum& operator+=(const bignum& rhs) {                                 // += bignum
-       	if (rhs.data.size() == 1 && rhs.data[0] == 0) { 
-            return *this; 
+    static void mul_ntt(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+        // every column sum is below an * 2^128 < p1 * p2 * p3              // mul_ntt()
+        const ntt_prime* m = ntt_primes();
+
+        size_t n = 1;
+        while (n < an + bn) {
+            n <<= 1;
         }
 
-        *this = *this + rhs;
-        return *this;
+        bool    parallel = bn >= parallel_threshold;
+        scratch c1(n), c2(n), c3(n);
+
+        run_tasks(parallel,                                                     // primes are independent
+                  [&] { ntt_convolution(c1.buf, a, an, b, bn, m[0], parallel); },
+                  [&] { ntt_convolution(c2.buf, a, an, b, bn, m[1], parallel); },
+                  [&] { ntt_convolution(c3.buf, a, an, b, bn, m[2], parallel); });
+
+        // Garner: x = v1 + p1 * v2 + p1 * p2 * v3, constants in Montgomery form
+        auto reduce = [](uint64_t x, uint64_t p) {
+            while (x >= p) {
+                x -= p;
+            }
+            return x;
+        };
+
+        const uint64_t p1 = m[0].p, p2 = m[1].p, p3 = m[2].p;
+        const uint64_t p1_p3      = m[2].to_mont(reduce(p1, p3));
+        const uint64_t p1_inv_p2  = m[1].pow(m[1].to_mont(reduce(p1, p2)), p2 - 2);
+        const uint64_t p12_inv_p3 = m[2].pow(m[2].mul(p1_p3, m[2].to_mont(reduce(p2, p3))), p3 - 2);
+        const u128     p12        = static_cast<u128>(p1) * p2;
+        const limb     p12_lo     = static_cast<limb>(p12);
+        const limb     p12_hi     = static_cast<limb>(p12 >> limb_bits);
+
+        // column value and running carry are up to three limbs
+        limb carry[3] = {0, 0, 0};
+
+        for (size_t i = 0; i < an + bn; ++i) {
+            limb x[3] = {0, 0, 0};
+
+            if (i + 1 < an + bn) {
+                uint64_t v1 = c1[i];
+                uint64_t v2 = m[1].mul(m[1].sub(c2[i], reduce(v1, p2)), p1_inv_p2);
+                uint64_t t  = m[2].sub(m[2].sub(c3[i], reduce(v1, p3)), m[2].mul(reduce(v2, p3), p1_p3));
+                uint64_t v3 = m[2].mul(t, p12_inv_p3);
+
+                u128 low  = static_cast<u128>(p1) * v2 + v1;
+                u128 mid  = static_cast<u128>(p12_lo) * v3;
+                u128 high = static_cast<u128>(p12_hi) * v3;
+
+                limb terms[3][3] = {
+                    {static_cast<limb>(low), static_cast<limb>(low  >> limb_bits), 0},
+                    {static_cast<limb>(mid), static_cast<limb>(mid  >> limb_bits), 0},
+                    {0,                      static_cast<limb>(high),              static_cast<limb>(high >> limb_bits)},
+                };
+                for (const auto& term : terms) {
+                    add(x, x, 3, term, 3);
+                }
+            }
+
+            add(x, x, 3, carry, 3);
+
+            r[i]     = x[0];
+            carry[0] = x[1];
+            carry[1] = x[2];
+        }
     }
 
-    bignum& operator*=(const bignum& rhs) {                                 // *= bignum
-        if (rhs.data.size() == 1 && rhs.data[0] == 1) { 
-            return *this; 
+    // ------------------------------------- division and decimal conversion ------------------------------------- //
+
+    static limbs v_shift(const limbs& x, size_t k) {                            // v_shift(), x * B^k
+        if (x.empty()) {
+            return {};
         }
+        limbs res(k, 0);
+        res.insert(res.end(), x.begin(), x.end());
+        return res;
+    }
 
-        *this = *this * rhs;
-        return *this;
+    static limbs v_high(const limbs& x, size_t k) {                             // v_high(), x / B^k
+        return x.size() > k ? limbs(x.begin() + k, x.end()) : limbs{};
     }
 
-    std::string to_string() const {                                         // to_string()  
-        std::stringstream ss;
-        std::string       curr{};
+    static int v_compare(const limbs& x, const limbs& y) {                      // v_compare()
+        return compare(x.data(), x.size(), y.data(), y.size());
+    }
+
+    static void divmod_knuth(limbs& q, limbs& r, const limbs& u, const limbs& v) {
+        // Knuth D, v is shifted so that its top bit is set                    // divmod_knuth()
+        size_t n = v.size();
+
+        if (v_compare(u, v) < 0) {
+            q.clear();
+            r = u;
+            return;
+        }
 
-        size_t d_size = data.size();
+        if (n == 1) {
+            q.assign(u.size(), 0);
+            r.assign(1, divrem_1(q.data(), u.data(), u.size(), v[0]));
+            q.resize(normalized(q.data(), q.size()));
+            r.resize(normalized(r.data(), r.size()));
+            return;
+        }
+
+        size_t   m     = u.size() - n;
+        unsigned shift = static_cast<unsigned>(__builtin_clzll(v[n - 1]));
+
+        scratch vn(n), un(u.size() + 1);
+
+        std::copy(v.begin(), v.end(), vn.data());
+        std::copy(u.begin(), u.end(), un.data());
+
+        if (shift != 0) {
+            lshift(vn.data(), v.data(), n, shift);
+            un[u.size()] = lshift(un.data(), u.data(), u.size(), shift);
+        }
+
+        dlimb top  = vn[n - 1];
+        dlimb next = vn[n - 2];
+
+        q.assign(m + 1, 0);
 
-        std::vector<std::vector<uint32_t>> vec_numb(d_size, std::vector<uint32_t>{});
+        for (size_t j = m + 1; j-- > 0;) {
+            dlimb num  = (static_cast<dlimb>(un[j + n]) << limb_bits) | un[j + n - 1];
+            dlimb qhat = num / top;
+            dlimb rhat = num % top;
 
-        for (size_t i = 0; i < d_size; ++i) {
-            curr = std::to_string(data[i]);
-            
-            for (auto j = curr.rbegin();  j < curr.rend(); ++j) {
-                vec_numb[i].push_back((*j - '0'));
+            while ((qhat >> limb_bits) != 0 || qhat * next > ((rhat << limb_bits) | un[j + n - 2])) {
+                --qhat;
+                rhat += top;
+                if ((rhat >> limb_bits) != 0) {
+                    break;
+                }
+            }
+
+            limb borrow = submul_1(un.data() + j, vn.data(), n, static_cast<limb>(qhat));
+
+            if (un[j + n] < borrow) {                                           // qhat was one too big
+                --qhat;
+                add(un.data() + j, un.data() + j, n, vn.data(), n);
             }
+            un[j + n] = 0;
+
+            q[j] = static_cast<limb>(qhat);
+        }
+
+        r.assign(un.data(), un.data() + n);
+        if (shift != 0) {
+            rshift(r.data(), r.data(), n, shift);
+        }
 
+        q.resize(normalized(q.data(), q.size()));
+        r.resize(normalized(r.data(), r.size()));
+    }
+
+    static limbs v_inverse(const limbs& d) {                                    // v_inverse(), B^2n / d
+        // one Newton step from the reciprocal of the top half of d
+        size_t n = d.size();
+
+        limbs one(2 * n + 1, 0);
+        one[2 * n] = 1;
+
+        if (n <= inverse_threshold) {
+            limbs q, r;
+            divmod_knuth(q, r, one, d);
+            return q;
         }
 
-        std::vector<uint32_t> res = *vec_numb.rbegin();
-        std::vector<uint32_t> tmp{};
+        size_t h = (n + 1) / 2 + 2;
+        limbs  x = v_shift(v_inverse(limbs(d.end() - h, d.end())), n - h);
 
-        for (auto numb = vec_numb.rbegin() + 1; numb < vec_numb.rend(); ++numb) {
-            tmp.assign(res.size() + bignum::u_base_vec.size(), 0);            // Horner's method
+        // x += x * (B^2n - d * x) / B^2n
+        limbs dx = v_mul(d, x);
 
-            bignum_prod(tmp, res, bignum::u_base_vec, bignum::d_base);
+        if (v_compare(dx, one) <= 0) {
+            x = v_add(x, v_high(v_mul(x, v_sub(one, dx)), 2 * n));
+        } else {
+            x = v_sub(x, v_high(v_mul(x, v_sub(dx, one)), 2 * n));
+        }
 
-            tmp.push_back(0);
-            bignum_sum (tmp, *numb, tmp.size(), bignum::d_base);
+        // the step is exact up to a few units
+        const limbs unit = {1};
 
-            res = tmp;
+        dx = v_mul(d, x);
+        while (v_compare(dx, one) > 0) {
+            x  = v_sub(x, unit);
+            dx = v_sub(dx, d);
         }
 
-        for (auto i = res.rbegin(); i < res.rend(); ++i) {
-            ss << *i;
+        limbs rest = v_sub(one, dx);
+        while (v_compare(rest, d) >= 0) {
+            x    = v_add(x, unit);
+            rest = v_sub(rest, d);
         }
 
-        return ss.str();
+        return x;
     }
 
-    void bignum_sum(      std::vector<uint32_t>& result,                    // bignum_sum() 
-                    const std::vector<uint32_t>& rhs, 
-                                          size_t res_size, 
-                                        uint64_t base) const
-    {
+    static void divmod_inverse(limbs& q, limbs& r,                              // divmod_inverse()
+                               const limbs& x, const limbs& d, const limbs& inv) {
+        // x < B^2n and inv = B^2n / d, so the estimate is at most one short
+        q = v_high(v_mul(x, inv), 2 * d.size());
+        r = v_sub(x, v_mul(q, d));
+
+        while (v_compare(r, d) >= 0) {
+            r = v_sub(r, d);
+            q = v_add(q, {1});
+        }
+    }
 
-        size_t   rhs_size = rhs.size();
-        uint64_t sum      = 0;
+    struct decimal_powers {                                                     // 10^(19 * 2^i), reciprocals
+        std::vector<limbs> powers;
+        std::vector<limbs> inverses;
 
-        for (size_t i = 0; i < res_size; ++i) {     // O(n)
-            if (i < rhs_size) {
-                sum  += rhs[i];
+        const limbs& power(size_t i) {
+            if (powers.empty()) {
+                powers.push_back({chunk_base});
             }
-            sum      += result[i];
+            while (powers.size() <= i) {
+                powers.push_back(v_mul(powers.back(), powers.back()));
+            }
+            return powers[i];
+        }
 
-            result[i] = sum % base;  
-            sum       = sum / base;
+        const limbs& inverse(size_t i) {
+            if (inverses.size() <= i) {
+                inverses.resize(i + 1);
+            }
+            if (inverses[i].empty()) {
+                inverses[i] = v_inverse(power(i));
+            }
+            return inverses[i];
         }
+    };
 
-        zero_cleaner(result);
+    static decimal_powers& thread_powers() {                                    // thread_powers()
+        // powers and reciprocals survive between conversions on the same thread
+        thread_local decimal_powers powers;
+        return powers;
     }
 
-    void bignum_prod(      std::vector<uint32_t>& result,                   // bignum_prod()
-                     const std::vector<uint32_t>& upper, 
-                     const std::vector<uint32_t>& lower, 
-                                         uint64_t base) const
-    {
-        
-        size_t r_size = result.size();
-        size_t u_size =  upper.size();
-        size_t l_size =  lower.size();
+    static void print_decimal(std::string& out, const limbs& x, size_t k,     // print_decimal()
+                              size_t pad, decimal_powers& powers) {
+        // x < 10^(19 * 2^k), pad is the digit count to fill with zeros, 0 for the leading part
+        if (k == 0 || x.size() <= conversion_threshold) {
+            // 10^19 chunks from the lowest, digits go straight to out from the highest
+            scratch rest(x.size()), chunks(2 * x.size());
+            size_t  count = 0;
 
-        size_t      t = 0;
-        size_t      k = 0;
+            std::copy(x.begin(), x.end(), rest.data());
 
-        uint64_t  sum = 0;
-        uint64_t prod = 1;
+            for (size_t n = x.size(); n > 0; n = normalized(rest.data(), n)) {
+                chunks[count++] = divrem_1(rest.data(), rest.data(), n, chunk_base);
+            }
+
+            char   top[chunk_digits];                                           // reversed
+            size_t top_len = 0;
+
+            for (limb chunk = count != 0 ? chunks[count - 1] : 0; chunk != 0; chunk /= 10) {
+                top[top_len++] = static_cast<char>('0' + chunk % 10);
+            }
 
-        for (size_t i = 0; i < l_size; ++i) {               // O(n^2)
+            size_t digits = count != 0 ? top_len + chunk_digits * (count - 1) : 0;
 
-            std::vector<uint64_t> buffer(u_size + 1, 0);
+            if (pad > digits) {
+                out.append(pad - digits, '0');
+            }
+            while (top_len != 0) {
+                out += top[--top_len];
+            }
 
-            for (size_t j = 0; j < u_size; ++j) {
-                prod           = lower[i];                  
-                prod          *= upper[j];                  
+            for (size_t i = count != 0 ? count - 1 : 0; i-- > 0;) {
+                char part[chunk_digits];
+                limb chunk = chunks[i];
 
-                sum            = prod % base;
-                sum           += buffer[j];
-                
-                buffer[j]      = sum  % base;
-                buffer[j + 1]  = sum  / base;
-                buffer[j + 1] += prod / base;
+                for (size_t j = chunk_digits; j-- > 0; chunk /= 10) {
+                    part[j] = static_cast<char>('0' + chunk % 10);
+                }
+                out.append(part, chunk_digits);
             }
+            return;
+        }
+
+        if (pad == 0 && v_compare(x, powers.power(k - 1)) < 0) {
+            print_decimal(out, x, k - 1, 0, powers);                            // no leading zeros
+            return;
+        }
+
+        limbs q, r;
+        divmod_inverse(q, r, x, powers.power(k - 1), powers.inverse(k - 1));
+
+        size_t low = chunk_digits << (k - 1);
 
-            t   = 0;
-            sum = 0;
+        print_decimal(out, q, k - 1, pad == 0 ? 0 : pad - low, powers);
+        print_decimal(out, r, k - 1, low, powers);
+    }
+
+    static limbs parse_decimal(const char* s, size_t len, decimal_powers& powers) {
+        // x = high * 10^(19 * 2^k) + low, the low part takes 19 * 2^k digits // parse_decimal()
+        if (len <= chunk_digits * conversion_threshold) {
+            limbs  x(len / chunk_digits + 1, 0);
+            size_t n = 0;
 
-            for (size_t p = k; p < r_size; ++p) {
+            for (size_t pos = 0; pos < len;) {
+                size_t step  = (pos == 0 && len % chunk_digits != 0) ? len % chunk_digits : chunk_digits;
+                limb   chunk = 0;
+                limb   scale = 1;
 
-                if (t < u_size + 1) {
-                    sum += buffer[t];
-                    ++t;
+                for (size_t i = 0; i < step; ++i, ++pos) {
+                    chunk  = chunk * 10 + (s[pos] - '0');
+                    scale *= 10;
                 }
-                sum      += result[p];
 
-                result[p] = sum % base;
-                sum       = sum / base;
+                limb carry = mul_1(x.data(), x.data(), n, scale, chunk);
+                if (carry != 0) {
+                    x[n++] = carry;
+                }
             }
+
+            x.resize(n);
+            return x;
+        }
+
+        size_t k = 0;
+        while ((chunk_digits << (k + 1)) < len) {
             ++k;
         }
 
-        zero_cleaner(result);
+        size_t low = chunk_digits << k;
+
+        limbs high = parse_decimal(s, len - low, powers);
+        limbs rest = parse_decimal(s + len - low, low, powers);
+
+        return v_add(v_mul(high, powers.power(k)), rest);
+    }
+
+    static limbs from_decimal(const std::string& decimal_str) {                 // from_decimal()
+        if (decimal_str.empty() ||
+            decimal_str.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("bignum: not a decimal number: " + decimal_str);
+        }
+
+        decimal_powers& powers = thread_powers();
+
+        limbs x = parse_decimal(decimal_str.data(), decimal_str.size(), powers);
+        x.resize(normalized(x.data(), x.size()));
+        return x;
     }
 
-    // bases
-    static const uint64_t       u_base     = 4294967295;
-    static const uint64_t       d_base     = 10;
-    const std::vector<uint32_t> u_base_vec = {5,9,2,7,6,9,4,9,2,4};
+    // ------------------------------------------- modular arithmetic ------------------------------------------- //
 
-    // friends
-    friend const bignum operator+(const bignum& lhs, const bignum& rhs);
-    friend const bignum operator*(const bignum& lhs, const bignum& rhs);
+    static limbs limbs_of(const bignum& x) {                                    // limbs_of(), normalized
+        return v_slice(x.data.data(), x.data.size());
+    }
 
-    friend std::ostream& operator<<(std::ostream& os, const bignum& rhs);
-    friend std::istream& operator>>(std::istream& is, const bignum& rhs);
+    static bignum from_limbs(const limbs& x) {                                  // from_limbs()
+        bignum res{};
+        if (!x.empty()) {
+            res.data.assign(x.begin(), x.end());
+        }
+        return res;
+    }
 
-    // deleted operators
-    bignum&             operator--()                                     = delete;
-    bignum&             operator-=(const bignum& rhs)                    = delete;
-    bignum&             operator- (const bignum& rhs)                    = delete;
-    friend const bignum operator- (const bignum& lhs, const bignum& rhs) = delete;
+    static limbs v_mod(const limbs& x, const limbs& m) {                        // v_mod()
+        limbs q, r;
+        divmod_knuth(q, r, x, m);
+        return r;
+    }
 
-    private: // -----------------------------------------bignum private ----------------------------------------- //
+    static limb mont_inverse(limb m0) {                                         // mont_inverse(), -m0^-1 mod 2^64
+        limb inv = m0;
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - m0 * inv;
+        }
+        return 0 - inv;
+    }
 
-    void recursive_div(const std::string& number) {                            // bignum_prod()
-        if (number.length() < 10) {
+    static void sqr_basecase(limb* r, const limb* a, size_t n) {                // sqr_basecase()
+        // cross products once, doubled, plus the squares on the diagonal
+        std::fill(r, r + 2 * n, 0);
 
-            data.push_back(stoul(number));
+        for (size_t i = 0; i + 1 < n; ++i) {
+            r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+        lshift(r, r, 2 * n, 1);
 
-        } else { 
+        limb carry = 0;
 
-            std::string res{};                                                // recursive division
+        for (size_t i = 0; i < n; ++i) {
+            dlimb sq = static_cast<dlimb>(a[i]) * a[i];
+            dlimb lo = static_cast<dlimb>(r[2 * i]) + static_cast<limb>(sq) + carry;
+            dlimb hi = static_cast<dlimb>(r[2 * i + 1]) + static_cast<limb>(sq >> limb_bits)
+                     + static_cast<limb>(lo >> limb_bits);
 
-            uint64_t l    = 0;
-            uint64_t end  = number.length();   
-            uint64_t div  = stoull(number.substr(l, 19)) / bignum::u_base;    // first 19 digits
-            uint64_t mod  = stoull(number.substr(l, 19)) % bignum::u_base;
+            r[2 * i]     = static_cast<limb>(lo);
+            r[2 * i + 1] = static_cast<limb>(hi);
+            carry        = static_cast<limb>(hi >> limb_bits);
+        }
+    }
 
-            res          += std::to_string(div);
-            l = 19;
-            
-            uint64_t acc  = mod * 10 + (number[l] - '0');
+    static void mont_reduce(limb* r, limb* t, const limb* m, size_t n, limb m_inv) {
+        // r = t / B^n mod m for t < m * B^n in 2n limbs, t is destroyed       // mont_reduce()
+        limb over = 0;
 
-            while (l < end) {
-                
-                if (acc < bignum::u_base && l + 1 != end) {
-                    while (acc < bignum::u_base) {
-                        res += "0";
-                        acc *= 10;
-                        ++l;
-                        acc += number[l] - '0';
-                    }
-                }
-                
-                div  = acc / bignum::u_base;
-                mod  = acc % bignum::u_base;
+        for (size_t i = 0; i < n; ++i) {
+            limb  u   = t[i] * m_inv;                                           // clears t[i]
+            limb  c   = addmul_1(t + i, m, n, u);
+            dlimb top = static_cast<dlimb>(t[i + n]) + c + over;
 
-                res += std::to_string(div);
-                ++l;
+            t[i + n] = static_cast<limb>(top);
+            over     = static_cast<limb>(top >> limb_bits);
+        }
 
-                acc = mod * 10 + (number[l] - '0');
-            }
-            data.push_back(mod);
+        if (over != 0 || compare(t + n, n, m, n) >= 0) {                        // t / B^n < 2m
+            sub(r, t + n, n, m, n);
+        } else {
+            std::copy(t + n, t + 2 * n, r);
+        }
+    }
+
+    static void mont_mul(limb* r, const limb* a, const limb* b,                 // mont_mul()
+                         const limb* m, size_t n, limb m_inv, limb* t) {
+        // r = a * b / B^n mod m, a, b < m, t is scratch of 2n limbs
+        if (a == b) {
+            sqr_basecase(t, a, n);
+        } else {
+            mul_basecase(t, a, n, b, n);
+        }
+        mont_reduce(r, t, m, n, m_inv);
+    }
+
+    template <typename MulMod>
+    static limbs window_pow(const limbs& base, const limbs& exp, MulMod mulmod) {
+        // left to right sliding window over the odd powers base^1, base^3, ...  // window_pow()
+        // exp > 0, mulmod(r, a, b) writes a * b into r, r is never a or b
+        size_t   bits = exp.size() * limb_bits - static_cast<size_t>(__builtin_clzll(exp.back()));
+        unsigned w    = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
 
-            recursive_div(res);     // recursive division
+        auto bit = [&exp](size_t i) {
+            return (exp[i / limb_bits] >> (i % limb_bits)) & 1;
+        };
+
+        std::vector<limbs> odd(size_t(1) << (w - 1));
+        odd[0] = base;
+
+        if (odd.size() > 1) {
+            limbs square;
+            mulmod(square, base, base);
+
+            for (size_t i = 1; i < odd.size(); ++i) {
+                mulmod(odd[i], odd[i - 1], square);
+            }
         }
-    } 
 
-    void zero_cleaner(std::vector<uint32_t>& vec) const {                       // zero_cleaner()
-        // deletes last zeros
-        if (vec.size() > 1) {
-            
-            auto i = vec.rbegin();
-            size_t cnt = 0;
+        limbs res, tmp;
+        bool  started = false;
+
+        for (size_t i = bits; i-- > 0;) {
+            if (!bit(i)) {
+                mulmod(tmp, res, res);
+                res.swap(tmp);
+                continue;
+            }
+
+            // the longest window of at most w bits that ends with a one
+            size_t low = i + 1 >= w ? i + 1 - w : 0;
+            while (!bit(low)) {
+                ++low;
+            }
+
+            size_t value = 0;
+            for (size_t j = i + 1; j-- > low;) {
+                value = value * 2 + bit(j);
+
+                if (started) {
+                    mulmod(tmp, res, res);
+                    res.swap(tmp);
+                }
+            }
 
-            while (*i == 0) {
-                ++cnt;
-                ++i;
+            if (started) {
+                mulmod(tmp, res, odd[value >> 1]);
+                res.swap(tmp);
+            } else {
+                res     = odd[value >> 1];
+                started = true;
             }
 
-            vec.resize(vec.size() - cnt);
+            i = low;
+        }
+
+        return res;
+    }
+
+    static limbs v_pow_mod(const limbs& base, const limbs& exp, const limbs& m) {   // v_pow_mod(), m > 1
+        limbs b = v_mod(base, m);
+
+        if (exp.empty()) {
+            return {1};
+        }
+        if (b.empty()) {
+            return {};
+        }
+
+        if ((m[0] & 1) == 0) {
+            // even modulus: no Montgomery form, plain multiplication and Knuth D
+            return window_pow(b, exp, [&m](limbs& r, const limbs& x, const limbs& y) {
+                r = v_mod(v_mul(x, y), m);
+            });
         }
+
+        // odd modulus: values are kept as x * B^n mod m in n limbs
+        size_t n     = m.size();
+        limb   m_inv = mont_inverse(m[0]);
+        limbs  t(2 * n);
+
+        auto mulmod = [&](limbs& r, const limbs& x, const limbs& y) {
+            r.resize(n);
+            mont_mul(r.data(), x.data(), y.data(), m.data(), n, m_inv, t.data());
+        };
+
+        limbs mont = v_mod(v_shift(b, n), m);
+        mont.resize(n);
+
+        limbs res = window_pow(mont, exp, mulmod);
+
+        limbs unit(n, 0);
+        unit[0] = 1;
+
+        mont_mul(res.data(), res.data(), unit.data(), m.data(), n, m_inv, t.data());
+        res.resize(normalized(res.data(), n));
+
+        return res;
+    }
+
+    void zero_cleaner(limb_storage& vec) const {                                // zero_cleaner()
+        // deletes last zeros, zero keeps one limb
+        vec.resize(std::max<size_t>(normalized(vec.data(), vec.size()), 1));
     }
 
-    std::string           big_str = {};
-    std::vector<uint32_t> data    = {};
+    std::string           big_str = {};     // decimal cache, empty when stale
+    limb_storage          data    = {};     // values up to inline_limbs * 64 bits stay off the heap
 
 }; // bignum
 
 inline std::ostream& operator<<(std::ostream& os, const bignum& rhs) {
-    os << rhs.big_str;
+    os << rhs.decimal();
     return os;
 }
 
@@ -292,7 +1566,7 @@ inline std::istream& operator>>(std::istream& is, bignum& rhs) {
     return is;
 }
 
-inline const bignum operator+(const bignum& lhs, const bignum& rhs) {
+inline bignum operator+(const bignum& lhs, const bignum& rhs) {
 
     bignum res{};
 
@@ -302,21 +1576,20 @@ inline const bignum operator+(const bignum& lhs, const bignum& rhs) {
     if (l_size == 1 && lhs.data[0] == 0) { return rhs; }
     if (r_size == 1 && rhs.data[0] == 0) { return lhs; }
 
-    res.data = (l_size > r_size) ? lhs.data : rhs.data;
-    res.data.push_back(0);
-
-    size_t res_size = std::max(l_size, r_size) + 1;
+    const bignum& upper = (l_size > r_size) ? lhs : rhs;
+    const bignum& lower = (l_size > r_size) ? rhs : lhs;
 
-    (l_size > r_size) ? res.bignum_sum(res.data, rhs.data, res_size, bignum::u_base) 
-                      : res.bignum_sum(res.data, lhs.data, res_size, bignum::u_base);
+    size_t res_size = upper.data.size();
 
+    res.data.resize(res_size + 1);
+    res.data[res_size] = bignum::add(res.data.data(), upper.data.data(), res_size, lower.data.data(), lower.data.size());
 
-    res.big_str = res.to_string();
+    res.zero_cleaner(res.data);
 
     return res;
 }
 
-inline const bignum operator*(const bignum& lhs, const bignum& rhs) {
+inline bignum operator*(const bignum& lhs, const bignum& rhs) {
 
     bignum res{};
 
@@ -327,10 +1600,176 @@ inline const bignum operator*(const bignum& lhs, const bignum& rhs) {
 
     res.data.resize(l_size + r_size);
 
-    (l_size > r_size) ? res.bignum_prod(res.data, lhs.data, rhs.data, bignum::u_base) 
-                      : res.bignum_prod(res.data, rhs.data, lhs.data, bignum::u_base);
-
-    res.big_str = res.to_string();
+    bignum::mul(res.data.data(), lhs.data.data(), l_size, rhs.data.data(), r_size);
+    res.zero_cleaner(res.data);
 
     return res;
 }
+
+// rvalue overloads reuse the temporary's limbs
+inline bignum operator+(bignum&& lhs, const bignum& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+inline bignum operator+(const bignum& lhs, bignum&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+inline bignum operator+(bignum&& lhs, bignum&& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+inline bignum operator*(bignum&& lhs, const bignum& rhs) {
+    lhs *= rhs;
+    return std::move(lhs);
+}
+
+inline bignum operator*(const bignum& lhs, bignum&& rhs) {
+    rhs *= lhs;
+    return std::move(rhs);
+}
+
+inline bignum operator*(bignum&& lhs, bignum&& rhs) {
+    lhs *= rhs;
+    return std::move(lhs);
+}
+
+inline std::pair<bignum, bignum> divmod(const bignum& lhs, const bignum& rhs) {
+    // quotient and remainder, Knuth D
+    bignum::limbs d = bignum::limbs_of(rhs);
+
+    if (d.empty()) {
+        throw std::domain_error("bignum: division by zero");
+    }
+
+    bignum::limbs q, r;
+    bignum::divmod_knuth(q, r, bignum::limbs_of(lhs), d);
+
+    return {bignum::from_limbs(q), bignum::from_limbs(r)};
+}
+
+inline bignum mod(const bignum& lhs, const bignum& rhs) {
+    return divmod(lhs, rhs).second;
+}
+
+inline bignum operator/(const bignum& lhs, const bignum& rhs) {
+    return divmod(lhs, rhs).first;
+}
+
+inline bignum operator%(const bignum& lhs, const bignum& rhs) {
+    return divmod(lhs, rhs).second;
+}
+
+inline bignum pow_mod(const bignum& base, const bignum& exp, const bignum& m) {
+    // base^exp mod m, Montgomery multiplication for odd m
+    bignum::limbs modulus = bignum::limbs_of(m);
+
+    if (modulus.empty()) {
+        throw std::domain_error("bignum: pow_mod by zero modulus");
+    }
+    if (modulus.size() == 1 && modulus[0] == 1) {
+        return bignum{};
+    }
+
+    return bignum::from_limbs(bignum::v_pow_mod(bignum::limbs_of(base), bignum::limbs_of(exp), modulus));
+}
+
+class bignum_accumulator {                                                      // bignum_accumulator
+    // carry-save sum: every limb position keeps its wrapped sum and the count of carries out of it,
+    // adds never propagate, value() does it once
+public:
+    bignum_accumulator& operator+=(const bignum& rhs) {                     // += bignum
+        add_lanes(rhs.data.data(), nullptr, rhs.data.size());
+        return *this;
+    }
+
+    bignum_accumulator& operator+=(const bignum_accumulator& rhs) {         // += bignum_accumulator
+        add_lanes(rhs.low.data(), rhs.carries.data(), rhs.low.size());
+        return *this;
+    }
+
+    bignum value() const {                                                  // value()
+        // low + carries * 2^64, fits in one more limb while fewer than 2^64 values were added
+        size_t n = low.size();
+
+        bignum res{};
+        res.data.assign(n + 1, 0);
+
+        std::copy(low.begin(), low.end(), res.data.data());
+        bignum::add(res.data.data() + 1, res.data.data() + 1, n, carries.data(), n);
+
+        res.zero_cleaner(res.data);
+        return res;
+    }
+
+    void clear() {                                                          // clear()
+        low.clear();
+        carries.clear();
+    }
+
+private:
+    void add_lanes(const uint64_t* x, const uint64_t* x_carries, size_t n) {    // add_lanes()
+        if (low.size() < n) {
+            low.resize(n, 0);
+            carries.resize(n, 0);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t sum = low[i] + x[i];
+
+            carries[i] += (sum < x[i]) + (x_carries != nullptr ? x_carries[i] : 0);
+            low[i]      = sum;
+        }
+    }
+
+    std::vector<uint64_t> low     = {};     // position sums mod 2^64
+    std::vector<uint64_t> carries = {};     // carries out of each position
+};
+
+template <typename It>
+bignum sum(It first, It last) {
+    // carry-save partial sums over contiguous chunks, one per thread, merged at the end
+    const size_t count  = static_cast<size_t>(std::distance(first, last));
+    const size_t chunk  = 4096;                                                 // values per thread at least
+    size_t       shares = std::min<size_t>(bignum::threads(), (count + chunk - 1) / chunk);
+
+    if (shares <= 1) {
+        bignum_accumulator acc;
+        for (; first != last; ++first) {
+            acc += *first;
+        }
+        return acc.value();
+    }
+
+    std::vector<bignum_accumulator> partial(shares);
+
+    bignum::run_shares(true, shares, [&](size_t i) {                            // within the helper budget
+        It begin = std::next(first, static_cast<std::ptrdiff_t>(count * i / shares));
+        It end   = std::next(first, static_cast<std::ptrdiff_t>(count * (i + 1) / shares));
+
+        for (It it = begin; it != end; ++it) {
+            partial[i] += *it;
+        }
+    });
+
+    for (size_t i = 1; i < shares; ++i) {
+        partial[0] += partial[i];
+    }
+
+    return partial[0].value();
+}
+
+
+template <typename It>
+bignum product(It first, It last, bool parallel) {
+    // balanced product tree, subtrees go to helper threads when parallel
+    std::vector<bignum> values(first, last);
+
+    if (values.empty()) {
+        return bignum(1);
+    }
+    return bignum::product_tree(values.data(), values.size(), parallel);
+}
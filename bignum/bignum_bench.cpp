@@ -0,0 +1,151 @@
+/*
+    Bignum benchmarks: ns/op and heap allocations/op.
+
+    g++ -std=c++17 -O2 -pthread bignum_bench.cpp -o bignum_bench
+    ./bignum_bench [max_limbs = 1000000] [min_seconds = 0.2]
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "bignum.hpp"
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {                                               // counts every allocation
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// not inlined, so that gcc does not pair the free() with its builtin new
+__attribute__((noinline)) void operator delete(void* ptr) noexcept           { std::free(ptr); }
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept   { std::free(ptr); }
+
+void* operator new[](size_t size)                   { return operator new(size); }
+void  operator delete[](void* ptr) noexcept         { operator delete(ptr); }
+void  operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+using bench_clock = std::chrono::steady_clock;
+
+static double min_seconds = 0.2;
+
+template <typename Op>
+static void bench(const std::string& name, size_t limbs, Op op) {
+    // op is repeated until min_seconds pass, at least once
+    size_t reps    = 0;
+    size_t before  = allocations.load();
+    double elapsed = 0;
+
+    auto start = bench_clock::now();
+    do {
+        op();
+        ++reps;
+        elapsed = std::chrono::duration<double>(bench_clock::now() - start).count();
+    } while (elapsed < min_seconds);
+
+    size_t allocs = allocations.load() - before;
+
+    std::cout << std::left  << std::setw(16) << name
+              << std::right << std::setw(10) << limbs
+              << std::setw(16) << std::fixed << std::setprecision(1) << elapsed * 1e9 / reps
+              << std::setw(14) << std::setprecision(2) << static_cast<double>(allocs) / reps
+              << std::endl;
+}
+
+static std::string random_decimal(size_t limbs, std::mt19937_64& gen) {
+    // about as many digits as limbs * 64 bits take
+    size_t      digits = std::max<size_t>(1, limbs * 64 * 30103 / 100000);
+    std::string s(digits, '0');
+
+    for (auto& c : s) {
+        c = static_cast<char>('0' + gen() % 10);
+    }
+    s[0] = static_cast<char>('1' + gen() % 9);
+
+    return s;
+}
+
+static void operations(size_t max_limbs) {
+    std::mt19937_64 gen(2019);
+
+    for (size_t limbs = 1; limbs <= max_limbs; limbs = (limbs * 4 > max_limbs && limbs < max_limbs) ? max_limbs : limbs * 4) {
+        std::string a_str = random_decimal(limbs, gen);
+        std::string b_str = random_decimal(limbs, gen);
+
+        const bignum a(a_str);
+        const bignum b(b_str);
+        bignum       res{};
+
+        bench("string ctor", limbs, [&] { res = bignum(a_str); });
+        bench("to_string",   limbs, [&] { a_str = a.to_string(); });
+        bench("+",           limbs, [&] { res = a + b; });
+        bench("+=",          limbs, [&] { res += b; });
+        bench("*",           limbs, [&] { res = a * b; });
+        bench("*= (copy)",   limbs, [&] { res = a; res *= b; });              // includes the reset copy
+    }
+
+    bignum res{};
+    uint32_t x = 0;
+
+    bench("uint32 ctor", 1, [&] { res = bignum(++x); });
+}
+
+static void kernels() {
+    bench("factorial 20000", 0, [] {
+        bignum f(1);
+        for (uint32_t i = 2; i <= 20000; ++i) {
+            f *= bignum(i);
+        }
+    });
+
+    bench("fibonacci 100000", 0, [] {
+        bignum prev(0), cur(1);
+        for (size_t i = 1; i < 100000; ++i) {
+            prev += cur;
+            std::swap(prev, cur);
+        }
+    });
+
+    std::mt19937_64     gen(7);
+    std::vector<bignum> lhs, rhs;
+
+    for (size_t i = 0; i < 1000; ++i) {
+        lhs.emplace_back(random_decimal(64, gen));
+        rhs.emplace_back(random_decimal(64, gen));
+    }
+
+    bench("sum of products", 64, [&] {
+        bignum acc{};
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            acc += lhs[i] * rhs[i];
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    size_t max_limbs = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if (argc > 2) {
+        min_seconds = std::strtod(argv[2], nullptr);
+    }
+
+    std::cout << std::left  << std::setw(16) << "operation"
+              << std::right << std::setw(10) << "limbs"
+              << std::setw(16) << "ns/op"
+              << std::setw(14) << "allocs/op" << std::endl;
+
+    operations(std::max<size_t>(max_limbs, 1));
+    kernels();
+
+    return 0;
+}
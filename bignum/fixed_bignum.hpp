@@ -0,0 +1,208 @@
+/*
+    Fixed width unsigned bignum, arithmetic mod 2^Bits.
+    Base = 2^64, limbs on the stack, everything constexpr.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <stdexcept>
+
+#include "bignum.hpp"
+
+template <size_t Bits>
+struct fixed_bignum {
+    static_assert(Bits > 0 && Bits % 64 == 0, "fixed_bignum: Bits must be a positive multiple of 64");
+
+    using limb  = uint64_t;
+    using dlimb = unsigned __int128;
+
+    static constexpr size_t limb_bits  = 64;
+    static constexpr size_t limb_count = Bits / limb_bits;
+
+    constexpr fixed_bignum() : limbs{} {}
+
+    constexpr fixed_bignum(uint64_t value) : limbs{} {                     // fixed_bignum(uint64_t)
+        limbs[0] = value;
+    }
+
+    explicit fixed_bignum(const bignum& value) : limbs{} {                  // fixed_bignum(bignum), mod 2^Bits
+        size_t n = std::min(value.data.size(), limb_count);
+
+        for (size_t i = 0; i < n; ++i) {
+            limbs[i] = value.data[i];
+        }
+    }
+
+    static constexpr fixed_bignum parse(std::string_view decimal) {         // parse(), mod 2^Bits
+        if (decimal.empty()) {
+            throw std::invalid_argument("fixed_bignum: empty decimal number");
+        }
+
+        fixed_bignum res{};
+
+        for (char c : decimal) {
+            if (c < '0' || c > '9') {
+                throw std::invalid_argument("fixed_bignum: not a decimal number");
+            }
+            res = res * fixed_bignum(10) + fixed_bignum(static_cast<limb>(c - '0'));
+        }
+        return res;
+    }
+
+    bignum to_bignum() const {                                              // to_bignum()
+        bignum res{};
+
+        res.data.assign(limbs.begin(), limbs.end());
+        res.zero_cleaner(res.data);
+
+        return res;
+    }
+
+    explicit operator bignum() const {                                      // bignum()
+        return to_bignum();
+    }
+
+    explicit constexpr operator bool() const {                              // bool
+        limb any = 0;
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            any |= limbs[i];
+        }
+        return any != 0;
+    }
+
+    constexpr fixed_bignum& operator+=(const fixed_bignum& rhs) {           // += fixed_bignum
+        limb carry = 0;
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            dlimb sum = static_cast<dlimb>(limbs[i]) + rhs.limbs[i] + carry;
+
+            limbs[i] = static_cast<limb>(sum);
+            carry    = static_cast<limb>(sum >> limb_bits);
+        }
+        return *this;
+    }
+
+    constexpr fixed_bignum& operator-=(const fixed_bignum& rhs) {           // -= fixed_bignum, wraps
+        limb borrow = 0;
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            dlimb diff = static_cast<dlimb>(limbs[i]) - rhs.limbs[i] - borrow;
+
+            limbs[i] = static_cast<limb>(diff);
+            borrow   = static_cast<limb>(diff >> limb_bits) & 1;
+        }
+        return *this;
+    }
+
+    constexpr fixed_bignum& operator*=(const fixed_bignum& rhs) {           // *= fixed_bignum
+        *this = *this * rhs;
+        return *this;
+    }
+
+    constexpr fixed_bignum& operator<<=(size_t shift) {                     // <<= bits
+        size_t   whole = shift / limb_bits;
+        unsigned bits  = static_cast<unsigned>(shift % limb_bits);
+
+#pragma GCC unroll 16
+        for (size_t k = 0; k < limb_count; ++k) {                           // from the top, in place
+            size_t i    = limb_count - 1 - k;
+            limb   low  = i >= whole     ? limbs[i - whole]     : 0;
+            limb   next = i >= whole + 1 ? limbs[i - whole - 1] : 0;
+
+            limbs[i] = bits == 0 ? low : (low << bits) | (next >> (limb_bits - bits));
+        }
+        return *this;
+    }
+
+    constexpr fixed_bignum& operator>>=(size_t shift) {                     // >>= bits
+        size_t   whole = shift / limb_bits;
+        unsigned bits  = static_cast<unsigned>(shift % limb_bits);
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            limb high = i + whole     < limb_count ? limbs[i + whole]     : 0;
+            limb next = i + whole + 1 < limb_count ? limbs[i + whole + 1] : 0;
+
+            limbs[i] = bits == 0 ? high : (high >> bits) | (next << (limb_bits - bits));
+        }
+        return *this;
+    }
+
+    friend constexpr fixed_bignum operator+(fixed_bignum lhs, const fixed_bignum& rhs) {
+        return lhs += rhs;
+    }
+
+    friend constexpr fixed_bignum operator-(fixed_bignum lhs, const fixed_bignum& rhs) {
+        return lhs -= rhs;
+    }
+
+    friend constexpr fixed_bignum operator*(const fixed_bignum& lhs, const fixed_bignum& rhs) {
+        // schoolbook, the limbs above 2^Bits are never computed
+        fixed_bignum res{};
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            limb carry = 0;
+
+#pragma GCC unroll 16
+            for (size_t j = 0; i + j < limb_count; ++j) {
+                dlimb t = static_cast<dlimb>(lhs.limbs[j]) * rhs.limbs[i] + res.limbs[i + j] + carry;
+
+                res.limbs[i + j] = static_cast<limb>(t);
+                carry            = static_cast<limb>(t >> limb_bits);
+            }
+        }
+        return res;
+    }
+
+    friend constexpr fixed_bignum operator<<(fixed_bignum lhs, size_t shift) {
+        return lhs <<= shift;
+    }
+
+    friend constexpr fixed_bignum operator>>(fixed_bignum lhs, size_t shift) {
+        return lhs >>= shift;
+    }
+
+    friend constexpr int compare(const fixed_bignum& lhs, const fixed_bignum& rhs) {
+        for (size_t i = limb_count; i-- > 0;) {
+            if (lhs.limbs[i] != rhs.limbs[i]) {
+                return lhs.limbs[i] < rhs.limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    friend constexpr bool operator==(const fixed_bignum& lhs, const fixed_bignum& rhs) {
+        limb diff = 0;
+
+#pragma GCC unroll 16
+        for (size_t i = 0; i < limb_count; ++i) {
+            diff |= lhs.limbs[i] ^ rhs.limbs[i];
+        }
+        return diff == 0;
+    }
+
+    friend constexpr bool operator!=(const fixed_bignum& lhs, const fixed_bignum& rhs) { return !(lhs == rhs);          }
+    friend constexpr bool operator< (const fixed_bignum& lhs, const fixed_bignum& rhs) { return compare(lhs, rhs) <  0; }
+    friend constexpr bool operator<=(const fixed_bignum& lhs, const fixed_bignum& rhs) { return compare(lhs, rhs) <= 0; }
+    friend constexpr bool operator> (const fixed_bignum& lhs, const fixed_bignum& rhs) { return compare(lhs, rhs) >  0; }
+    friend constexpr bool operator>=(const fixed_bignum& lhs, const fixed_bignum& rhs) { return compare(lhs, rhs) >= 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, const fixed_bignum& rhs) {
+        return os << rhs.to_bignum();
+    }
+
+    std::array<limb, limb_count> limbs;     // lowest limb first
+};
+
+using uint128_fixed = fixed_bignum<128>;
+using uint256_fixed = fixed_bignum<256>;
+using uint512_fixed = fixed_bignum<512>;
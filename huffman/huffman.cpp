@@ -125,6 +125,33 @@ void print_statistics(size_t                input_size,
     }
 }
 
+void print_sampling_loss(const std::vector<size_t>&  exact_freqs,
+                         size_t                      sampled_bits) {
+
+    std::vector<CharData> chars_freqs{};
+    for (size_t c = 0; c < exact_freqs.size(); ++c) {
+        if (exact_freqs[c] != 0) {
+            chars_freqs.push_back({std::string(1, static_cast<unsigned char> (c)), exact_freqs[c]});
+        }
+    }
+
+    if (chars_freqs.empty()) {
+        return;
+    }
+
+    char_code_map exact_codes = huffman_encoding(chars_freqs);
+
+    size_t exact_bits = 0;
+    for (const auto& item: chars_freqs) {
+        exact_bits += item.frequency * exact_codes[item.chars[0]].length();
+    }
+
+    double loss = 100.0 * (static_cast<double> (sampled_bits) - exact_bits) / exact_bits;
+
+    std::cout << (exact_bits + 7) / 8 << std::endl <<
+                 loss                 << std::endl;
+}
+
 void write_file(const std::string&      file_name,
                 const std::string&      output_str) {
 
@@ -163,6 +190,42 @@ std::vector<CharData> chars_frequencies(const char*     content,
     return chars_freq_vec;
 }
 
+std::vector<CharData> sampled_chars_frequencies(const char*     content,
+                                                    size_t      size,
+                                                    size_t      window,
+                                                    double      coverage) {
+    // estimates frequencies from evenly spaced windows instead of a full pass
+
+    size_t windows = (window == 0) ? 0 : static_cast<size_t> (size * coverage) / window;
+
+    if (windows == 0 || coverage >= 1.0) {
+        return chars_frequencies(content, size);
+    }
+
+    size_t stride  = size / windows;
+    size_t sampled = 0;
+
+    std::vector<size_t> counts(256, 0);
+
+    for (size_t k = 0; k < windows; ++k) {
+        const unsigned char* begin = reinterpret_cast<const unsigned char*> (content) + k * stride;
+
+        for (size_t i = 0; i < window; ++i) {
+            ++counts[begin[i]];
+        }
+        sampled += window;
+    }
+
+    // every byte value keeps a code: unseen values get the minimum frequency
+    std::vector<CharData> chars_freq_vec{};
+    for (size_t c = 0; c < 256; ++c) {
+        size_t frequency = counts[c] * (size / sampled);
+        chars_freq_vec.push_back({std::string(1, static_cast<unsigned char> (c)), std::max<size_t> (frequency, 1)});
+    }
+
+    return chars_freq_vec;
+}
+
 std::string huffman_decoding(const std::string&     encoded_str,
                              const Node*            root,
                              char_code_map&         chars_codes) {
@@ -432,17 +495,26 @@ Node* build_alphabet_tree(const std::string&    alphabet,
     return root;
 }
 
-std::string encode_string(const char*       content,
-                         size_t             size,
-                         char_code_map&     char_freq_map,
-                         size_t&            bits_data) {
+std::string encode_string(const char*           content,
+                          size_t                size,
+                          char_code_map&        char_freq_map,
+                          size_t&               bits_data,
+                          std::vector<size_t>*  exact_freqs) {
 
     std::string bit_encoded_str{};
 
     size_t len = size;
 
+    if (exact_freqs != nullptr) {
+        exact_freqs->assign(256, 0);
+    }
+
     for (size_t i = 0; i < len; ++i) {
         bit_encoded_str += char_freq_map[content[i]];
+
+        if (exact_freqs != nullptr) {   // exact histogram in the same pass
+            ++(*exact_freqs)[static_cast<unsigned char> (content[i])];
+        }
     }
 
     len = bit_encoded_str.length();
@@ -482,6 +554,32 @@ void encoding(const char*           input_str,
     write_file(output_file, get_out_str(alphabet, encoded_tree, encoded_str, bits_tree, bits_data));
 }
 
+void sampled_encoding(const char*           input_str,
+                      size_t                input_size,
+                      const std::string&    output_file,
+                      bool                  is_console,
+                      memory_vector&        nodes) {
+
+    size_t              bits_data   = 0;
+    size_t              bits_tree   = 0;
+    std::string         alphabet    = {};
+    std::vector<size_t> exact_freqs = {};
+
+    std::vector<CharData>   chars_freqs   = sampled_chars_frequencies (input_str, input_size);
+    char_code_map           chars_codes   = huffman_encoding          (chars_freqs);
+    std::string             encoded_str   = encode_string             (input_str, input_size, chars_codes, bits_data, &exact_freqs);
+    Node*                   root          = build_tree_with_map       (chars_codes, nodes);
+    std::string             encoded_tree  = encode_tree               (root, bits_tree, alphabet);
+
+    print_statistics(input_size, encoded_str.length(), alphabet.length() + encoded_tree.length() + 6, chars_codes, is_console);
+
+    if (is_console) {
+        print_sampling_loss(exact_freqs, encoded_str.length() * 8 - bits_data);
+    }
+
+    write_file(output_file, get_out_str(alphabet, encoded_tree, encoded_str, bits_tree, bits_data));
+}
+
 void decoding(std::vector<std::string>  v_alphabet_tree_str,
               size_t                    input_size,
               size_t                    alpha_size,
@@ -497,3 +595,208 @@ void decoding(std::vector<std::string>  v_alphabet_tree_str,
     print_statistics(input_size - alpha_size - tree_size - 6, decoded_str.length(), alpha_size + tree_size + 6, chars_codes, is_console);
     write_file(output_file, decoded_str);
 }
+
+size_t table_cost(const std::vector<size_t>&    freqs,
+                  const char_code_map&          chars_codes) {
+    // encoded size in bits, SIZE_MAX if some byte has no code in the table
+
+    size_t bits = 0;
+
+    for (size_t c = 0; c < freqs.size(); ++c) {
+        if (freqs[c] == 0) {
+            continue;
+        }
+
+        auto code = chars_codes.find(static_cast<unsigned char> (c));
+        if (code == chars_codes.end()) {
+            return SIZE_MAX;
+        }
+
+        bits += freqs[c] * code->second.length();
+    }
+
+    return bits;
+}
+
+std::string bytes_to_bits(const char*   begin,
+                          const char*   end,
+                          size_t        padding) {
+
+    std::string bits{};
+    for (auto i = begin; i < end; ++i) {
+        std::bitset<8> byte(*i);
+        bits += byte.to_string();
+    }
+
+    return bits.empty() ? bits : std::string(bits.begin(), bits.end() - padding);
+}
+
+void block_encoding(const char*         input_str,
+                    size_t              input_size,
+                    const std::string&  output_file,
+                    bool                is_console,
+                    memory_vector&      nodes) {
+    // block: N (new table) | R (reuse previous table), [table], padding, data length, data
+
+    std::string   out        = {};
+    char_code_map prev_codes = {};
+
+    size_t data_size  = 0;
+    size_t blocks     = 0;
+    size_t new_tables = 0;
+
+    for (size_t begin = 0; begin < input_size; begin += block_size) {
+        const char* block = input_str + begin;
+        size_t      len   = std::min(block_size, input_size - begin);
+
+        std::vector<size_t> freqs(256, 0);
+        for (size_t i = 0; i < len; ++i) {
+            ++freqs[static_cast<unsigned char> (block[i])];
+        }
+
+        std::vector<CharData> chars_freqs{};
+        for (size_t c = 0; c < 256; ++c) {
+            if (freqs[c] != 0) {
+                chars_freqs.push_back({std::string(1, static_cast<unsigned char> (c)), freqs[c]});
+            }
+        }
+
+        char_code_map new_codes = huffman_encoding(chars_freqs);
+
+        size_t leaves     = chars_freqs.size();
+        size_t table_bits = 8 * (3 + leaves + (2 * leaves - 1 + 7) / 8);    // alphabet + dfs tree
+        size_t new_cost   = table_cost(freqs, new_codes) + table_bits;
+        size_t prev_cost  = table_cost(freqs, prev_codes);
+
+        if (prev_cost <= new_cost) {
+
+            out += 'R';
+
+        } else {
+
+            size_t      bits_tree = 0;
+            std::string alphabet  = {};
+            Node*       root      = build_tree_with_map(new_codes, nodes);
+            std::string tree      = encode_tree(root, bits_tree, alphabet);
+
+            out += 'N';
+            out += static_cast<unsigned char> (alphabet.length() - 1);
+            out += static_cast<unsigned char> (bits_tree);
+            out += static_cast<unsigned char> (tree.length());
+            out += alphabet + tree;
+
+            prev_codes = new_codes;
+            ++new_tables;
+        }
+
+        size_t      bits_data = 0;
+        std::string encoded   = encode_string(block, len, prev_codes, bits_data);
+
+        out += static_cast<unsigned char> (bits_data);
+        for (size_t k = 0; k < 4; ++k) {
+            out += static_cast<unsigned char> (encoded.length() >> (8 * k));
+        }
+        out += encoded;
+
+        data_size += encoded.length();
+        ++blocks;
+    }
+
+    print_statistics(input_size, data_size, out.length() - data_size, prev_codes, false);
+
+    if (is_console) {
+        std::cout << blocks << std::endl << new_tables << std::endl;
+    }
+
+    write_file(output_file, out);
+}
+
+void block_decoding(const char*         input_str,
+                    size_t              input_size,
+                    const std::string&  output_file,
+                    bool                is_console,
+                    memory_vector&      nodes) {
+
+    const unsigned char* in = reinterpret_cast<const unsigned char*> (input_str);
+
+    std::string out  = {};
+    Node*       root = nullptr;
+
+    size_t data_size  = 0;
+    size_t blocks     = 0;
+    size_t new_tables = 0;
+    size_t pos        = 0;
+    bool   corrupted  = false;
+
+    // true when count more bytes are left, pos never passes input_size
+    auto available = [&](size_t count) { return count <= input_size - pos; };
+
+    while (pos < input_size) {
+        unsigned char marker = in[pos];
+        ++pos;
+
+        if (marker == 'N') {
+            if (!available(3)) {
+                corrupted = true;
+                break;
+            }
+            size_t alph_size = static_cast<size_t> (in[pos]) + 1;
+            size_t bits_tree = in[pos + 1];
+            size_t tree_len  = in[pos + 2];
+            pos += 3;
+
+            if (!available(alph_size + tree_len)) {
+                corrupted = true;
+                break;
+            }
+            std::string alphabet(input_str + pos, input_str + pos + alph_size);
+            pos += alph_size;
+
+            std::string tree = bytes_to_bits(input_str + pos, input_str + pos + tree_len, bits_tree);
+            pos += tree_len;
+
+            root = build_alphabet_tree(alphabet, tree, nodes);
+            ++new_tables;
+
+        } else if (marker != 'R' || root == nullptr) {
+            corrupted = true;
+            break;
+        }
+
+        if (!available(5)) {
+            corrupted = true;
+            break;
+        }
+        size_t bits_data = in[pos];
+        size_t len       = 0;
+        for (size_t k = 0; k < 4; ++k) {
+            len |= static_cast<size_t> (in[pos + 1 + k]) << (8 * k);
+        }
+        pos += 5;
+
+        if (!available(len)) {
+            corrupted = true;
+            break;
+        }
+
+        char_code_map chars_codes{};
+        out += huffman_decoding(bytes_to_bits(input_str + pos, input_str + pos + len, bits_data), root, chars_codes);
+
+        pos       += len;
+        data_size += len;
+        ++blocks;
+    }
+
+    if (corrupted) {
+        std::cout << "CORRUPTED BLOCK: at byte " << pos << " of " << input_size << std::endl;
+        return;
+    }
+
+    print_statistics(data_size, out.length(), input_size - data_size, {}, false);
+
+    if (is_console) {
+        std::cout << blocks << std::endl << new_tables << std::endl;
+    }
+
+    write_file(output_file, out);
+}
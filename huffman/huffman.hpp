@@ -32,6 +32,10 @@ using char_code_map = std::unordered_map<unsigned char, std::string>;
 using char_freq_map = std::map          <unsigned char, uint32_t>;
 using memory_vector = std::vector       <const Node*>;
 
+const size_t sample_window   = 64 * 1024;  // bytes in one sampled window
+const double sample_coverage = 0.01;       // sampled part of the input
+const size_t block_size      = 32 * 1024;  // bytes in one block of block encoding
+
 void encoding(const char*            input_str,
                   size_t             input_size,
                   const std::string& output_file,
@@ -39,6 +43,13 @@ void encoding(const char*            input_str,
                   memory_vector&     nodes
                   );
 
+void sampled_encoding(const char*        input_str,
+                      size_t             input_size,
+                      const std::string& output_file,
+                      bool               is_console,
+                      memory_vector&     nodes
+                      );
+
 void decoding(std::vector<std::string>          v_alphabet_tree_str,
                               size_t            input_size,
                               size_t            alpha_size,
@@ -48,6 +59,29 @@ void decoding(std::vector<std::string>          v_alphabet_tree_str,
                               memory_vector&    nodes
                               );
 
+void block_encoding(const char*          input_str,
+                    size_t               input_size,
+                    const std::string&   output_file,
+                    bool                 is_console,
+                    memory_vector&       nodes
+                    );
+
+void block_decoding(const char*          input_str,
+                    size_t               input_size,
+                    const std::string&   output_file,
+                    bool                 is_console,
+                    memory_vector&       nodes
+                    );
+
+size_t table_cost(const std::vector<size_t>&    freqs,
+                  const char_code_map&          chars_codes
+                  );
+
+std::string bytes_to_bits(const char*   begin,
+                          const char*   end,
+                          size_t        padding
+                          );
+
 Node* build_alphabet_tree(const std::string&    alphabet,
                           const std::string&    encoded_tree,
                           memory_vector&        nodes
@@ -67,10 +101,11 @@ std::string encode_tree(Node*           root,
                         std::string&    alphabet
                         );
 
-std::string encode_string(const std::string&        content,
+std::string encode_string(const char*               content,
                           size_t                    content_size,
                           char_code_map&            char_freq_map,
-                          size_t&                   bits_data
+                          size_t&                   bits_data,
+                          std::vector<size_t>*      exact_freqs = nullptr
                           );
 
 std::string get_out_str(const std::string&      alphabet,
@@ -90,6 +125,12 @@ std::vector<CharData> chars_frequencies(const char* content,
                                         size_t      size
                                         );
 
+std::vector<CharData> sampled_chars_frequencies(const char* content,
+                                                size_t      size,
+                                                size_t      window   = sample_window,
+                                                double      coverage = sample_coverage
+                                                );
+
 
 std::string   huffman_decoding(const std::string&   encoded_str,
                                const Node*          root,
@@ -106,6 +147,10 @@ void print_statistics(size_t                    input_size,
                       bool                      is_console
                      );
 
+void print_sampling_loss(const std::vector<size_t>&  exact_freqs,
+                         size_t                      sampled_bits
+                        );
+
 size_t get_file_size(const std::string& file_name);
 
 const char* get_char_content(const std::string& file_name,
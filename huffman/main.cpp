@@ -23,7 +23,10 @@ enum Errors {
 enum Flag {
     NOTHING,
     ENCODE,
-    DECODE
+    SAMPLED_ENCODE,
+    BLOCK_ENCODE,
+    DECODE,
+    BLOCK_DECODE
 };
 
 int process(int argc, char **argv) {
@@ -59,7 +62,7 @@ int process(int argc, char **argv) {
 
         } else {
 
-            std::cout << "INVALID FIRST FLAG: must be -v for 5 args, -c or -d for 4 args" << std::endl;
+            std::cout << "INVALID FIRST FLAG: must be -v for 5 args, -c, -s, -bc, -d or -bd for 4 args" << std::endl;
             return INVALID_FLAG;
         }
 
@@ -73,21 +76,34 @@ int process(int argc, char **argv) {
     // flag test
     if (commands[fst_arg_pos] == "") {
 
-        std::cout << "WITHOUT FLAG: must be (-v) -c or -d)" << std::endl;
+        std::cout << "WITHOUT FLAG: must be (-v) -c, -s, -bc, -d or -bd)" << std::endl;
         return WITHOUT_FLAG;
 
-    } else if (commands[fst_arg_pos] != "-c" && commands[fst_arg_pos] != "-d") {
+    } else if (commands[fst_arg_pos] != "-c"  && commands[fst_arg_pos] != "-s" && commands[fst_arg_pos] != "-d" &&
+               commands[fst_arg_pos] != "-bc" && commands[fst_arg_pos] != "-bd") {
 
-        std::cout << "INVALID FLAG: must be (-v) -c or -d" << std::endl;
+        std::cout << "INVALID FLAG: must be (-v) -c, -s, -bc, -d or -bd" << std::endl;
         return INVALID_FLAG;
 
     } else if (commands[fst_arg_pos] == "-c") {
 
         flag = ENCODE;
         
+    } else if (commands[fst_arg_pos] == "-s") {
+
+        flag = SAMPLED_ENCODE;
+
+    } else if (commands[fst_arg_pos] == "-bc") {
+
+        flag = BLOCK_ENCODE;
+
     } else if (commands[fst_arg_pos] == "-d") {
 
         flag = DECODE;
+
+    } else if (commands[fst_arg_pos] == "-bd") {
+
+        flag = BLOCK_DECODE;
     }
 
     // files
@@ -126,6 +142,21 @@ int process(int argc, char **argv) {
                         encoding(input_str, input_size, output_file, is_console, nodes);
                         break;
 
+                    case SAMPLED_ENCODE:
+
+                        sampled_encoding(input_str, input_size, output_file, is_console, nodes);
+                        break;
+
+                    case BLOCK_ENCODE:
+
+                        block_encoding(input_str, input_size, output_file, is_console, nodes);
+                        break;
+
+                    case BLOCK_DECODE:
+
+                        block_decoding(input_str, input_size, output_file, is_console, nodes);
+                        break;
+
                     case DECODE: {
 
                         size_t alphabet_size = 0;
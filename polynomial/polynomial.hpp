@@ -1,5 +1,5 @@
 /*
-    Polynomial.
+    Polynomial with uint32_t coefficients, arithmetic wraps mod 2^32.
     Ivan Rybin 2019.
 */
 
@@ -11,15 +11,122 @@
 #include <utility>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 struct polynomial {
-    explicit polynomial(const std::string& poly_str) {                          // polynomial(string)
+    polynomial() : coefficients({0}) {}                                         // polynomial(), zero
+
+    explicit polynomial(std::string_view poly_str) {                            // polynomial(string)
         poly_parse(poly_str);
     }
 
+    // "3*x^5 - x^2 + 7*x + 1", terms in any order, repeated exponents add up
+    static polynomial read(std::istream& in) {                                  // read(stream)
+        // chunks are cut at the last + or -, the unfinished term moves to the front
+        static const size_t chunk = size_t(1) << 16;
+
+        polynomial        res {};
+        std::vector<term> parsed {};
+        std::vector<char> buffer(chunk);
+        size_t            filled = 0;
+        bool              first  = true;
+
+        while (in) {
+            if (filled == buffer.size()) {                                      // one term longer than the buffer
+                buffer.resize(buffer.size() * 2);
+            }
+            in.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+            filled += static_cast<size_t>(in.gcount());
+
+            size_t cut = filled;
+            if (in) {
+                while (cut > 0 && buffer[cut - 1] != '+' && buffer[cut - 1] != '-') {
+                    --cut;
+                }
+                cut = cut > 1 ? cut - 1 : 0;
+            }
+
+            parse_terms(std::string_view(buffer.data(), cut), first, parsed);
+            std::copy(buffer.begin() + cut, buffer.begin() + filled, buffer.begin());
+            filled -= cut;
+        }
+
+        if (in.bad()) {
+            throw std::runtime_error("polynomial: read error");
+        }
+        res.finish_parse(first, parsed);
+        return res;
+    }
+
+    static polynomial read_file(const std::string& path) {                      // read_file()
+        // mapped into memory and parsed in place where there is mmap
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("polynomial: cannot open " + path);
+        }
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("polynomial: cannot stat " + path);
+        }
+        if (st.st_size == 0) {                                                  // mmap of nothing fails
+            ::close(fd);
+            return parse(std::string_view());
+        }
+
+        size_t size = static_cast<size_t>(st.st_size);
+        void*  data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (data == MAP_FAILED) {
+            std::ifstream in(path, std::ios_base::binary);
+            return read(in);
+        }
+        ::madvise(data, size, MADV_SEQUENTIAL);
+
+        try {
+            polynomial res = parse(std::string_view(static_cast<const char*>(data), size));
+            ::munmap(data, size);
+            return res;
+        } catch (...) {
+            ::munmap(data, size);
+            throw;
+        }
+#else
+        std::ifstream in(path, std::ios_base::binary);
+        if (!in) {
+            throw std::runtime_error("polynomial: cannot open " + path);
+        }
+        return read(in);
+#endif
+    }
+
+    static polynomial parse(std::string_view poly_str) {                        // parse()
+        polynomial res {};
+        res.poly_parse(poly_str);
+        return res;
+    }
+
     template<typename T> 
     const T operator()(const T& base) const {                                   // operator()
+        if (sparse) {
+            return sparse_eval(base);
+        }
 
         T sum = 0;
         sum   = *coefficients.rbegin();
@@ -31,7 +138,60 @@ struct polynomial {
         return sum;
     }
 
+    enum class scheme {
+        horner,                                 // one multiply-add per coefficient
+        estrin                                  // pairwise, shorter dependency chains for high degree
+    };
+
+    static const size_t eval_lanes = 16;        // points evaluated side by side
+
+    template<typename T>
+    void evaluate(const T* points, T* values, size_t count,                     // evaluate()
+                  scheme how = scheme::horner) const {
+        // blocks of eval_lanes points, every step is a loop over the lanes that the
+        // compiler turns into vector instructions of the target, values may be points
+        size_t i = 0;
+
+        if (sparse) {
+            for (; i < count; ++i) {
+                values[i] = sparse_eval(points[i]);
+            }
+            return;
+        }
+
+        if (how == scheme::estrin) {
+            std::vector<T> level(((coefficients.size() + 1) / 2) * eval_lanes);
+
+            for (; i + eval_lanes <= count; i += eval_lanes) {
+                estrin_block(points + i, values + i, level);
+            }
+        } else {
+            for (; i + eval_lanes <= count; i += eval_lanes) {
+                horner_block(points + i, values + i);
+            }
+        }
+
+        for (; i < count; ++i) {
+            values[i] = (*this)(points[i]);
+        }
+    }
+
+    template<typename T>
+    void evaluate(const std::vector<T>& points, std::vector<T>& values,         // evaluate(vector)
+                  scheme how = scheme::horner) const {
+        values.resize(points.size());
+        evaluate(points.data(), values.data(), points.size(), how);
+    }
+
     uint32_t& at(size_t pos) {                                                  // at()
+        if (sparse) {
+            auto it = find_term(pos);
+            if (it == terms.end() || it->first != pos) {
+                it = terms.insert(it, {pos, 0});
+            }
+            return it->second;
+        }
+
         if (pos >= coefficients.size()) {
             coefficients.resize(pos + 1, 0);
         }
@@ -39,46 +199,817 @@ struct polynomial {
     }
 
     const uint32_t& at(size_t pos) const {                                      // at() const
+        if (sparse) {
+            static const uint32_t zero = 0;
+
+            auto it = find_term(pos);
+            return (it == terms.end() || it->first != pos) ? zero : it->second;
+        }
         return coefficients[pos];
     }
 
+    size_t degree() const {                                                     // degree()
+        if (sparse) {
+            return terms.empty() ? 0 : terms.back().first;
+        }
+        return coefficients.empty() ? 0 : coefficients.size() - 1;
+    }
+
+    bool is_sparse() const {                                                    // is_sparse()
+        return sparse;
+    }
+
+    // sparse storage when the degree is this many times the number of terms
+    static const size_t sparse_density = 16;
+
+    // multiplication thresholds, in coefficients of the shorter operand
+    static const size_t karatsuba_threshold = 32;
+    static const size_t ntt_threshold       = 4096;
+    static const size_t ntt_max_length      = size_t(1) << 22;     // product length, CRT of three 30-bit primes stays exact
+
+    polynomial& operator+=(const polynomial& rhs) {                             // += polynomial
+        return combine(rhs, false);
+    }
+
+    polynomial& operator-=(const polynomial& rhs) {                             // -= polynomial
+        return combine(rhs, true);
+    }
+
+    polynomial& operator*=(const polynomial& rhs) {                             // *= polynomial
+        if (sparse || rhs.sparse) {
+            // every pair of terms, the exponents are too far apart for a dense product
+            std::vector<term> lhs_terms = nonzero_terms();
+            std::vector<term> rhs_terms = rhs.nonzero_terms();
+            std::vector<term> product {};
+
+            product.reserve(lhs_terms.size() * rhs_terms.size());
+            for (const term& l : lhs_terms) {
+                for (const term& r : rhs_terms) {
+                    product.emplace_back(l.first + r.first, l.second * r.second);
+                }
+            }
+
+            assign_terms(product, true);
+            return *this;
+        }
+
+        assign_dense(multiply(coefficients, rhs.coefficients));
+        return *this;
+    }
+
+    // multipoint evaluation: subproduct trees once both the points and the degree reach
+    // multipoint_threshold (measured crossover with the batch Horner), leaves of leaf_points
+    static const size_t multipoint_threshold = 32768;
+    static const size_t leaf_points          = 64;
+    static const size_t division_threshold   = 64;          // quotient length for schoolbook remainder
+
+    std::vector<uint32_t> multipoint(const std::vector<uint32_t>& points) const {   // multipoint()
+        // f mod prod (x - p_i) down a subproduct tree, so each leaf evaluates a remainder
+        // of degree below leaf_points, O(n log^2 n) for n points and degree n
+        std::vector<uint32_t> values {};
+
+        if (sparse || points.size() < multipoint_threshold || coefficients.size() <= multipoint_threshold) {
+            evaluate(points, values);
+            return values;
+        }
+
+        values.resize(points.size());
+
+        // one tree per chunk of about deg f points, more points than that only repeat the work
+        for (size_t begin = 0; begin < points.size(); begin += coefficients.size()) {
+            size_t count = std::min(points.size() - begin, coefficients.size());
+
+            multipoint_tree(points.data() + begin, count, values.data() + begin);
+        }
+
+        return values;
+    }
+
+    polynomial& reduce(uint32_t mod) {                                          // reduce(), coefficients mod m
+        if (mod == 0) {
+            throw std::domain_error("polynomial: reduce by zero");
+        }
+
+        if (sparse) {
+            std::vector<term> reduced = std::move(terms);
+            for (term& t : reduced) {
+                t.second %= mod;
+            }
+            assign_terms(reduced, true);
+        } else {
+            for (uint32_t& coef : coefficients) {
+                coef %= mod;
+            }
+            assign_dense(std::move(coefficients));
+        }
+        return *this;
+    }
+
 private:
 
-    void poly_parse(const std::string& poly) {                                  // poly_parse(string)
-        size_t begin = poly.find_first_of('^');
-        size_t end   = poly.find_first_of('+');
+    using term = std::pair<size_t, uint32_t>;   // (exponent, coefficient)
+
+    std::vector<term>::const_iterator find_term(size_t pos) const {             // find_term()
+        return std::lower_bound(terms.begin(), terms.end(), pos,
+                                [](const term& t, size_t exp) { return t.first < exp; });
+    }
+
+    std::vector<term>::iterator find_term(size_t pos) {                         // find_term()
+        return std::lower_bound(terms.begin(), terms.end(), pos,
+                                [](const term& t, size_t exp) { return t.first < exp; });
+    }
+
+    template<typename T>
+    static T power(T base, size_t exp) {                                        // power(), by squaring
+        T res = 1;
+
+        while (exp != 0) {
+            if (exp & 1) {
+                res *= base;
+            }
+            base *= base;
+            exp >>= 1;
+        }
+        return res;
+    }
+
+    template<typename T>
+    T sparse_eval(const T& base) const {                                        // sparse_eval()
+        // Horner over the terms, every gap between exponents is one power
+        T sum = 0;
+        sum   = terms.back().second;
+
+        for (size_t i = terms.size() - 1; i-- > 0;) {
+            sum *= power(base, terms[i + 1].first - terms[i].first);
+            sum += terms[i].second;
+        }
+        sum *= power(base, terms.front().first);
+
+        return sum;
+    }
+
+    void assign_terms(std::vector<term>& parsed, bool accumulate = false) {     // assign_terms()
+        // dense coefficients, or sorted terms when the degree is far above the term count;
+        // a repeated exponent keeps its last coefficient, or the sum when accumulating,
+        // accumulated zeros are dropped
+        std::stable_sort(parsed.begin(), parsed.end(),
+                         [](const term& lhs, const term& rhs) { return lhs.first < rhs.first; });
+
+        size_t unique = 0;
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            if (unique != 0 && parsed[unique - 1].first == parsed[i].first) {
+                parsed[unique - 1].second = accumulate ? parsed[unique - 1].second + parsed[i].second
+                                                       : parsed[i].second;
+            } else {
+                parsed[unique++] = parsed[i];
+            }
+        }
+        parsed.resize(unique);
+
+        if (accumulate) {
+            parsed.erase(std::remove_if(parsed.begin(), parsed.end(),
+                                        [](const term& t) { return t.second == 0; }),
+                         parsed.end());
+        }
+
+        size_t deg = parsed.empty() ? 0 : parsed.back().first;
+
+        sparse = !parsed.empty() && deg / sparse_density >= parsed.size();
+
+        if (sparse) {
+            terms = std::move(parsed);
+            coefficients.clear();
+        } else {
+            coefficients.assign(deg + 1, 0);
+            for (const term& t : parsed) {
+                coefficients[t.first] = t.second;
+            }
+            terms.clear();
+        }
+    }
+
+    // --------------------------------------------- arithmetic --------------------------------------------- //
+
+    using coefs = std::vector<uint32_t>;
+
+    std::vector<term> nonzero_terms() const {                                   // nonzero_terms()
+        std::vector<term> res {};
+
+        if (sparse) {
+            for (const term& t : terms) {
+                if (t.second != 0) {
+                    res.push_back(t);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < coefficients.size(); ++i) {
+                if (coefficients[i] != 0) {
+                    res.emplace_back(i, coefficients[i]);
+                }
+            }
+        }
+        return res;
+    }
+
+    polynomial& combine(const polynomial& rhs, bool subtract) {                 // combine(), + or -
+        if (sparse || rhs.sparse) {
+            std::vector<term> merged = nonzero_terms();
+
+            for (term t : rhs.nonzero_terms()) {
+                t.second = subtract ? 0u - t.second : t.second;
+                merged.push_back(t);
+            }
+
+            assign_terms(merged, true);
+            return *this;
+        }
+
+        if (coefficients.size() < rhs.coefficients.size()) {
+            coefficients.resize(rhs.coefficients.size(), 0);
+        }
+        for (size_t i = 0; i < rhs.coefficients.size(); ++i) {
+            coefficients[i] = subtract ? coefficients[i] - rhs.coefficients[i]
+                                       : coefficients[i] + rhs.coefficients[i];
+        }
+
+        assign_dense(std::move(coefficients));
+        return *this;
+    }
+
+    void assign_dense(coefs dense) {                                          // assign_dense()
+        // drops the leading zeros and switches to terms when few coefficients are left
+        size_t len = dense.size();
+        while (len > 1 && dense[len - 1] == 0) {
+            --len;
+        }
+        dense.resize(std::max<size_t>(len, 1));
+
+        size_t nonzero = static_cast<size_t>(std::count_if(dense.begin(), dense.end(),
+                                                           [](uint32_t c) { return c != 0; }));
+
+        if (nonzero != 0 && (dense.size() - 1) / sparse_density >= nonzero) {
+            std::vector<term> parsed {};
+            for (size_t i = 0; i < dense.size(); ++i) {
+                if (dense[i] != 0) {
+                    parsed.emplace_back(i, dense[i]);
+                }
+            }
+            assign_terms(parsed);
+            return;
+        }
+
+        coefficients = std::move(dense);
+        terms.clear();
+        sparse = false;
+    }
+
+    static coefs multiply(const coefs& a, const coefs& b) {                     // multiply()
+        coefs res(a.size() + b.size() - 1, 0);
+        mul(res.data(), a.data(), a.size(), b.data(), b.size());
+        return res;
+    }
+
+    static void mul(uint32_t* r, const uint32_t* a, size_t an,                  // mul(), r += a * b
+                    const uint32_t* b, size_t bn) {
+        // r has an + bn - 1 coefficients and must not overlap the operands
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+
+        if (bn < karatsuba_threshold) {
+            for (size_t j = 0; j < bn; ++j) {
+                const uint32_t y = b[j];
+                for (size_t i = 0; i < an; ++i) {
+                    r[i + j] += a[i] * y;
+                }
+            }
+
+        } else if (bn >= ntt_threshold && an + bn - 1 <= ntt_max_length) {
+            mul_ntt(r, a, an, b, bn);
+
+        } else if (an >= 2 * bn - 1) {
+            for (size_t off = 0; off < an; off += bn) {                         // bn-sized pieces of a
+                mul(r + off, a + off, std::min(bn, an - off), b, bn);
+            }
+
+        } else {
+            mul_karatsuba(r, a, an, b, bn);
+        }
+    }
+
+    static void mul_karatsuba(uint32_t* r, const uint32_t* a, size_t an,        // mul_karatsuba()
+                              const uint32_t* b, size_t bn) {
+        // a * b = z2 x^2h + ((a0 + a1)(b0 + b1) - z0 - z2) x^h + z0, h < bn <= an < 2h
+        size_t h  = (an + 1) / 2;
+        size_t a1 = an - h;
+        size_t b1 = bn - h;
+
+        coefs z0(2 * h - 1, 0), z2(a1 + b1 - 1, 0), z1(2 * h - 1, 0);
+        coefs sa(a, a + h), sb(b, b + h);
+
+        for (size_t i = 0; i < a1; ++i) { sa[i] += a[h + i]; }
+        for (size_t i = 0; i < b1; ++i) { sb[i] += b[h + i]; }
+
+        mul(z0.data(), a,     h,  b,     h);
+        mul(z2.data(), a + h, a1, b + h, b1);
+        mul(z1.data(), sa.data(), h, sb.data(), h);
+
+        for (size_t i = 0; i < z0.size(); ++i) { z1[i] -= z0[i]; r[i]         += z0[i]; }
+        for (size_t i = 0; i < z2.size(); ++i) { z1[i] -= z2[i]; r[i + 2 * h] += z2[i]; }
+        for (size_t i = 0; i < z1.size(); ++i) {                 r[i + h]     += z1[i]; }
+    }
+
+    void multipoint_tree(const uint32_t* points, size_t count, uint32_t* values) const {   // multipoint_tree()
+        // tree[0] are the leaves, tree[k + 1][i] = tree[k][2i] * tree[k][2i + 1], all monic
+        std::vector<std::vector<coefs>> tree(1);
+
+        for (size_t begin = 0; begin < count; begin += leaf_points) {
+            size_t end  = std::min(count, begin + leaf_points);
+            coefs  leaf = {1};
+
+            for (size_t i = begin; i < end; ++i) {                              // leaf *= x - p_i
+                leaf.push_back(0);
+                for (size_t j = leaf.size() - 1; j > 0; --j) {
+                    leaf[j] = leaf[j - 1] - leaf[j] * points[i];
+                }
+                leaf[0] = 0u - leaf[0] * points[i];
+            }
+            tree[0].push_back(std::move(leaf));
+        }
+
+        while (tree.back().size() > 1) {
+            const std::vector<coefs>& low = tree.back();
+            std::vector<coefs>        up {};
+
+            for (size_t i = 0; i + 1 < low.size(); i += 2) {
+                up.push_back(multiply(low[i], low[i + 1]));
+            }
+            if (low.size() % 2 != 0) {
+                up.push_back(low.back());
+            }
+            tree.push_back(std::move(up));
+        }
+
+        std::vector<coefs> rems = {poly_mod(coefficients, tree.back()[0])};
+
+        for (size_t level = tree.size() - 1; level-- > 0;) {
+            const std::vector<coefs>& nodes = tree[level];
+            std::vector<coefs>        down(nodes.size());
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                down[i] = poly_mod(rems[i / 2], nodes[i]);
+            }
+            rems = std::move(down);
+        }
+
+        for (size_t leaf = 0; leaf < rems.size(); ++leaf) {
+            const coefs& rem = rems[leaf];
+
+            for (size_t i = leaf * leaf_points; i < std::min(count, (leaf + 1) * leaf_points); ++i) {
+                uint32_t sum = 0;
+                for (size_t k = rem.size(); k-- > 0;) {
+                    sum = sum * points[i] + rem[k];
+                }
+                values[i] = sum;
+            }
+        }
+    }
+
+    static coefs series_inverse(const coefs& h, size_t k) {                     // series_inverse()
+        // h^-1 mod x^k for h[0] = 1, Newton: g = g * (2 - h * g), the precision doubles
+        coefs g = {1};
+
+        for (size_t len = 1; len < k;) {
+            len = std::min(2 * len, k);
+
+            coefs low(h.begin(), h.begin() + std::min(h.size(), len));
+            coefs hg = multiply(low, g);
+            hg.resize(len, 0);
+
+            for (uint32_t& c : hg) {
+                c = 0u - c;
+            }
+            hg[0] += 2;
+
+            g = multiply(g, hg);
+            g.resize(len, 0);
+        }
+        return g;
+    }
+
+    static coefs poly_mod(const coefs& a, const coefs& b) {                     // poly_mod(), b monic
+        // remainder with exactly deg b coefficients
+        size_t n = a.size();
+        size_t m = b.size();
+
+        if (n < m) {
+            coefs r(a);
+            r.resize(m - 1, 0);
+            return r;
+        }
+
+        size_t q_len = n - m + 1;
 
-        size_t p_deg = std::stoull(poly.substr(begin + 1, end - begin - 1));
+        if (q_len < division_threshold || m < division_threshold) {
+            coefs r(a);
 
-        coefficients.resize(p_deg + 1, 0);
+            for (size_t i = n; i-- > m - 1;) {
+                uint32_t c    = r[i];
+                size_t   base = i - (m - 1);
 
-        std::string part {};
+                for (size_t j = 0; c != 0 && j < m; ++j) {
+                    r[base + j] -= c * b[j];
+                }
+            }
+            r.resize(m - 1);
+            return r;
+        }
 
-        size_t  coef = 0;
-        size_t  deg  = 0;                       // x^0              - ok
-        size_t  star = 0;                       // 42*x^0           - ok
-        size_t  mid  = 0;                       // x^3 + x^2 + x^0  - ok
+        // reversed, the quotient is a power series division: rev(q) = rev(a) / rev(b) mod x^q_len
+        coefs ra(a.rbegin(), a.rbegin() + q_len);
+        coefs rb(b.rbegin(), b.rbegin() + std::min(m, q_len));
 
-        begin = 0;
-        end   = 0;
+        coefs q = multiply(ra, series_inverse(rb, q_len));
+        q.resize(q_len);
+        std::reverse(q.begin(), q.end());
 
-        while(end != std::string::npos) {
-            end   = poly.find_first_of('+', begin);
-            part  = poly.substr(begin, end - begin);
-            begin = end + 1;
+        coefs qb = multiply(q, b);
+        coefs r(m - 1);
 
-            star  = part.find_first_of('*');
-            mid   = part.find_first_of('^');
+        for (size_t i = 0; i < m - 1; ++i) {
+            r[i] = a[i] - qb[i];
+        }
+        return r;
+    }
 
-            (star == std::string::npos) ? coef = 1 
-                                        : coef = stoul(part.substr(0, mid + 1));
+    // ------------------------- NTT over three 30-bit primes, CRT straight to mod 2^32 ------------------------- //
 
-            deg   = stoul(part.substr(mid + 1, std::string::npos));
+    struct ntt_prime {
+        uint32_t p;
+        uint32_t g;         // primitive root
+        uint32_t inv;       // p^-1 mod 2^32
+        uint32_t r2;        // 2^64 mod p
+        uint32_t one;       // 2^32 mod p
 
-            coefficients[deg] = coef; 
+        ntt_prime(uint32_t p_, uint32_t g_) : p(p_), g(g_), inv(p_) {
+            for (int i = 0; i < 4; ++i) {
+                inv *= 2 - p * inv;
+            }
+            one = static_cast<uint32_t>((uint64_t(1) << 32) % p);
+            r2  = static_cast<uint32_t>(uint64_t(one) * one % p);
         }
+
+        uint32_t mul(uint32_t a, uint32_t b) const {                            // Montgomery a * b / 2^32
+            uint64_t t = uint64_t(a) * b;
+            uint32_t q = static_cast<uint32_t>(t) * inv;
+            uint32_t h = static_cast<uint32_t>((uint64_t(q) * p) >> 32);
+            uint32_t x = static_cast<uint32_t>(t >> 32);
+
+            return sub(x, h);
+        }
+
+        // branchless, operands are below p < 2^30 so the sign bit tells the wrap
+        uint32_t add(uint32_t a, uint32_t b) const { return sub(a + b, p); }
+        uint32_t sub(uint32_t a, uint32_t b) const {
+            uint32_t d = a - b;
+            return d + (p & (0u - (d >> 31)));
+        }
+
+        uint32_t to_mont  (uint32_t a) const { return mul(a % p, r2); }
+        uint32_t from_mont(uint32_t a) const { return mul(a, 1);      }
+
+        uint32_t pow(uint32_t a, uint64_t e) const {                            // Montgomery form in and out
+            uint32_t res = one;
+            for (; e != 0; e >>= 1) {
+                if (e & 1) {
+                    res = mul(res, a);
+                }
+                a = mul(a, a);
+            }
+            return res;
+        }
+    };
+
+    static const ntt_prime* ntt_primes() {                                      // ntt_primes()
+        static const ntt_prime primes[3] = {
+            {998244353u, 3},                                                    // 119 * 2^23 + 1
+            {167772161u, 3},                                                    //   5 * 2^25 + 1
+            {469762049u, 3},                                                    //   7 * 2^26 + 1
+        };
+        return primes;
     }
 
-    std::vector<uint32_t> coefficients = {};
+    static const size_t ntt_block = size_t(1) << 13;     // stages below this length run block by block in cache
+
+    static void ntt(coefs& a, bool invert, const ntt_prime& m) {                // ntt()
+        // forward is decimation in frequency and leaves the bit-reversed order, inverse is
+        // decimation in time from that order, so no bit reversal pass is needed in between
+        size_t n = a.size();
+
+        // roots of the stage of length len are at [len / 2, len)
+        coefs roots(std::max<size_t>(n, 2));
+
+        for (size_t len = 2; len <= n; len <<= 1) {
+            uint32_t w = m.pow(m.to_mont(m.g), (m.p - 1) / len);
+            if (invert) {
+                w = m.pow(w, m.p - 2);
+            }
+
+            size_t half = len / 2;
+            roots[half] = m.one;
+            for (size_t j = 1; j < half; ++j) {
+                roots[half + j] = m.mul(roots[half + j - 1], w);
+            }
+        }
+
+        auto stage = [&](size_t begin, size_t end, size_t len) {
+            size_t          half = len / 2;
+            const uint32_t* w    = roots.data() + half;
+
+            for (size_t i = begin; i < end; i += len) {
+                uint32_t* x = a.data() + i;
+                uint32_t* y = x + half;
+
+                for (size_t j = 0; j < half; ++j) {
+                    uint32_t u = x[j];
+
+                    if (invert) {
+                        uint32_t v = m.mul(y[j], w[j]);
+                        x[j] = m.add(u, v);
+                        y[j] = m.sub(u, v);
+                    } else {
+                        uint32_t v = y[j];
+                        x[j] = m.add(u, v);
+                        y[j] = m.mul(m.sub(u, v), w[j]);
+                    }
+                }
+            }
+        };
+
+        size_t block = std::min(n, ntt_block);
+
+        if (!invert) {
+            for (size_t len = n; len > block; len >>= 1) {
+                stage(0, n, len);
+            }
+            for (size_t begin = 0; begin < n; begin += block) {
+                for (size_t len = block; len >= 2; len >>= 1) {
+                    stage(begin, begin + block, len);
+                }
+            }
+            return;
+        }
+
+        for (size_t begin = 0; begin < n; begin += block) {
+            for (size_t len = 2; len <= block; len <<= 1) {
+                stage(begin, begin + block, len);
+            }
+        }
+        for (size_t len = 2 * block; len <= n; len <<= 1) {
+            stage(0, n, len);
+        }
+
+        uint32_t n_inv = m.pow(m.to_mont(static_cast<uint32_t>(n)), m.p - 2);
+        for (auto& x : a) {
+            x = m.from_mont(m.mul(x, n_inv));
+        }
+    }
+
+    static coefs ntt_convolution(const uint32_t* a, size_t an,                 // ntt_convolution()
+                                 const uint32_t* b, size_t bn,
+                                 size_t n, const ntt_prime& m) {
+        coefs fa(n, 0), fb(n, 0);
+
+        for (size_t i = 0; i < an; ++i) { fa[i] = m.to_mont(a[i]); }
+        for (size_t i = 0; i < bn; ++i) { fb[i] = m.to_mont(b[i]); }
+
+        ntt(fa, false, m);
+        ntt(fb, false, m);
+
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = m.mul(fa[i], fb[i]);
+        }
+
+        ntt(fa, true, m);
+        return fa;
+    }
+
+    static void mul_ntt(uint32_t* r, const uint32_t* a, size_t an,              // mul_ntt(), r += a * b
+                        const uint32_t* b, size_t bn) {
+        // an + bn - 1 <= 2^22, so exact coefficients are below 2^21 * 2^64 < p1 * p2 * p3
+        const ntt_prime* m = ntt_primes();
+
+        size_t len = an + bn - 1;
+        size_t n   = 1;
+        while (n < len) {
+            n <<= 1;
+        }
+
+        coefs c1 = ntt_convolution(a, an, b, bn, n, m[0]);
+        coefs c2 = ntt_convolution(a, an, b, bn, n, m[1]);
+        coefs c3 = ntt_convolution(a, an, b, bn, n, m[2]);
+
+        // Garner: x = v1 + p1 * v2 + p1 * p2 * v3, only x mod 2^32 is kept
+        const uint32_t p1 = m[0].p, p2 = m[1].p, p3 = m[2].p;
+
+        const uint32_t p1_inv_p2  = m[1].pow(m[1].to_mont(p1), p2 - 2);          // Montgomery form
+        const uint32_t p1_p3      = m[2].to_mont(p1);
+        const uint32_t p12_inv_p3 = m[2].pow(m[2].mul(p1_p3, m[2].to_mont(p2)), p3 - 2);
+        const uint32_t p12        = p1 * p2;                                    // mod 2^32
+
+        for (size_t i = 0; i < len; ++i) {
+            uint32_t v1 = c1[i];
+            uint32_t v2 = m[1].mul(m[1].sub(c2[i], v1 % p2), p1_inv_p2);
+            uint32_t t  = m[2].sub(m[2].sub(c3[i], v1 % p3), m[2].mul(v2 % p3, p1_p3));
+            uint32_t v3 = m[2].mul(t, p12_inv_p3);
+
+            r[i] += v1 + p1 * v2 + p12 * v3;
+        }
+    }
+
+    template<typename T>
+    void horner_block(const T* points, T* values) const {                       // horner_block()
+        T x[eval_lanes];
+        T acc[eval_lanes];
+
+        for (size_t lane = 0; lane < eval_lanes; ++lane) {
+            x[lane]   = points[lane];
+            acc[lane] = static_cast<T>(coefficients.back());
+        }
+
+        for (size_t k = coefficients.size() - 1; k-- > 0;) {
+            const T coef = static_cast<T>(coefficients[k]);
+
+            for (size_t lane = 0; lane < eval_lanes; ++lane) {
+                acc[lane] = acc[lane] * x[lane] + coef;
+            }
+        }
+
+        for (size_t lane = 0; lane < eval_lanes; ++lane) {
+            values[lane] = acc[lane];
+        }
+    }
+
+    template<typename T>
+    void estrin_block(const T* points, T* values, std::vector<T>& level) const {   // estrin_block()
+        // c0 + c1 x, c2 + c3 x, ... then pairs joined with x^2, x^4, ..., level is lane-major
+        const size_t L = eval_lanes;
+        const size_t n = coefficients.size();
+
+        T x[L];
+        T power[L];
+
+        for (size_t lane = 0; lane < L; ++lane) {
+            x[lane] = points[lane];
+        }
+
+        size_t m = (n + 1) / 2;
+
+        T sum[L];                               // stack results keep the lane loops free of aliasing
+
+        for (size_t k = 0; k < m; ++k) {
+            const T low  = static_cast<T>(coefficients[2 * k]);
+            const T high = 2 * k + 1 < n ? static_cast<T>(coefficients[2 * k + 1]) : T(0);
+
+            for (size_t lane = 0; lane < L; ++lane) {
+                sum[lane] = low + high * x[lane];
+            }
+            std::copy(sum, sum + L, level.begin() + k * L);
+        }
+
+        for (size_t lane = 0; lane < L; ++lane) {
+            power[lane] = x[lane] * x[lane];
+        }
+
+        while (m > 1) {
+            size_t pairs = m / 2;
+
+            for (size_t k = 0; k < pairs; ++k) {
+                const T* even = level.data() + 2 * k * L;
+                const T* odd  = even + L;
+
+                for (size_t lane = 0; lane < L; ++lane) {
+                    sum[lane] = even[lane] + odd[lane] * power[lane];
+                }
+                std::copy(sum, sum + L, level.begin() + k * L);
+            }
+            if (m % 2 != 0) {
+                std::copy(level.begin() + (m - 1) * L, level.begin() + m * L, level.begin() + pairs * L);
+            }
+
+            for (size_t lane = 0; lane < L; ++lane) {
+                power[lane] = power[lane] * power[lane];
+            }
+            m = (m + 1) / 2;
+        }
+
+        for (size_t lane = 0; lane < L; ++lane) {
+            values[lane] = level[lane];
+        }
+    }
+
+    void poly_parse(std::string_view poly) {                                    // poly_parse(string)
+        std::vector<term> parsed {};
+        bool              first = true;
+
+        parse_terms(poly, first, parsed);
+        finish_parse(first, parsed);
+    }
+
+    void finish_parse(bool first, std::vector<term>& parsed) {                  // finish_parse()
+        if (first) {
+            throw std::invalid_argument("polynomial: no terms");
+        }
+        assign_terms(parsed, true);
+    }
+
+    static void parse_terms(std::string_view text, bool& first,                 // parse_terms()
+                            std::vector<term>& parsed) {
+        // single pass with from_chars, text ends between two terms; a term is
+        // [+|-] coef, [+|-] [coef[*]] x [^deg], the sign is optional before the first one
+        const char* p    = text.data();
+        const char* last = text.data() + text.size();
+
+        auto skip_space = [&] {
+            while (p != last && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+                ++p;
+            }
+        };
+        auto fail = [](const char* what) {
+            throw std::invalid_argument(std::string("polynomial: ") + what);
+        };
+
+        for (skip_space(); p != last; skip_space()) {
+            bool negative = *p == '-';
+
+            if (*p == '+' || *p == '-') {
+                ++p;
+                skip_space();
+            } else if (!first) {
+                fail("expected + or - between terms");
+            }
+
+            uint64_t coef     = 1;
+            size_t   deg      = 0;
+            bool     has_coef = p != last && *p >= '0' && *p <= '9';
+
+            if (has_coef) {
+                auto res = std::from_chars(p, last, coef);
+                if (res.ec != std::errc()) {
+                    fail("coefficient out of range");
+                }
+                p = res.ptr;
+                skip_space();
+
+                if (p != last && *p == '*') {
+                    ++p;
+                    skip_space();
+                    if (p == last || *p != 'x') {
+                        fail("expected x after *");
+                    }
+                }
+            }
+
+            if (p != last && *p == 'x') {
+                ++p;
+                skip_space();
+                deg = 1;
+
+                if (p != last && *p == '^') {
+                    ++p;
+                    skip_space();
+
+                    auto res = std::from_chars(p, last, deg);
+                    if (res.ec != std::errc()) {
+                        fail("bad exponent");
+                    }
+                    p = res.ptr;
+                }
+            } else if (!has_coef) {
+                fail("expected a term");
+            }
+
+            uint32_t value = static_cast<uint32_t>(coef);
+            parsed.emplace_back(deg, negative ? 0u - value : value);
+            first = false;
+        }
+    }
+
+    std::vector<uint32_t> coefficients = {};    // dense, index is the exponent
+    std::vector<term>     terms        = {};    // sparse, ascending exponents
+    bool                  sparse       = false;
 
 }; // polynomial
+
+inline polynomial operator+(polynomial lhs, const polynomial& rhs) {
+    return lhs += rhs;
+}
+
+inline polynomial operator-(polynomial lhs, const polynomial& rhs) {
+    return lhs -= rhs;
+}
+
+inline polynomial operator*(polynomial lhs, const polynomial& rhs) {
+    return lhs *= rhs;
+}
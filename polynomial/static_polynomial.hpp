@@ -0,0 +1,173 @@
+/*
+    Polynomials fixed at compile time, uint32_t coefficients, arithmetic wraps mod 2^32.
+    No setup at runtime, evaluation is an unrolled Horner scheme and constexpr.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+
+#include "polynomial.hpp"
+
+template <uint32_t... Coeffs>                   // c0, c1, ..., lowest exponent first
+struct static_polynomial {
+    static_assert(sizeof...(Coeffs) > 0, "static_polynomial: no coefficients");
+
+    static constexpr size_t                                  degree       = sizeof...(Coeffs) - 1;
+    static constexpr std::array<uint32_t, sizeof...(Coeffs)> coefficients = {Coeffs...};
+
+    template<typename T>
+    constexpr T operator()(const T& base) const {                               // operator()
+        return horner(base, std::make_index_sequence<degree + 1>());
+    }
+
+    static constexpr uint32_t at(size_t pos) {                                  // at()
+        return pos <= degree ? coefficients[pos] : 0;
+    }
+
+    static polynomial to_polynomial() {                                         // to_polynomial()
+        polynomial res {};
+
+        for (size_t i = 0; i <= degree; ++i) {
+            if (coefficients[i] != 0) {
+                res.at(i) = coefficients[i];
+            }
+        }
+        return res;
+    }
+
+private:
+
+    template<typename T, size_t... I>
+    static constexpr T horner(const T& base, std::index_sequence<I...>) {      // horner(), one step per coefficient
+        T sum = 0;
+
+        ((sum = sum * base + static_cast<T>(coefficients[degree - I])), ...);
+        return sum;
+    }
+};
+
+template <size_t Degree>
+struct fixed_polynomial {
+    constexpr fixed_polynomial() : coefficients{} {}                            // fixed_polynomial(), zero
+
+    explicit constexpr fixed_polynomial(std::string_view poly) : coefficients{} {   // fixed_polynomial(string)
+        *this = parse(poly);
+    }
+
+    static constexpr fixed_polynomial parse(std::string_view poly) {            // parse()
+        // the grammar of polynomial(string): [+|-] [coef[*]] x [^deg] terms in any order,
+        // repeated exponents add up; errors become compile errors in a constant expression
+        fixed_polynomial res {};
+
+        size_t p     = 0;
+        bool   first = true;
+
+        auto skip_space = [&] {
+            while (p < poly.size() && (poly[p] == ' ' || poly[p] == '\t' || poly[p] == '\n' || poly[p] == '\r')) {
+                ++p;
+            }
+        };
+        auto is_digit = [&] {
+            return p < poly.size() && poly[p] >= '0' && poly[p] <= '9';
+        };
+        auto number = [&] {
+            uint64_t value = 0;
+
+            for (; is_digit(); ++p) {
+                uint64_t digit = static_cast<uint64_t>(poly[p] - '0');
+                if (value > (UINT64_MAX - digit) / 10) {
+                    throw std::invalid_argument("fixed_polynomial: number out of range");
+                }
+                value = value * 10 + digit;
+            }
+            return value;
+        };
+
+        for (skip_space(); p < poly.size(); skip_space()) {
+            bool negative = poly[p] == '-';
+
+            if (poly[p] == '+' || poly[p] == '-') {
+                ++p;
+                skip_space();
+            } else if (!first) {
+                throw std::invalid_argument("fixed_polynomial: expected + or - between terms");
+            }
+
+            bool     has_coef = is_digit();
+            uint64_t coef     = has_coef ? number() : 1;
+            uint64_t deg      = 0;
+
+            skip_space();
+            if (has_coef && p < poly.size() && poly[p] == '*') {
+                ++p;
+                skip_space();
+                if (p == poly.size() || poly[p] != 'x') {
+                    throw std::invalid_argument("fixed_polynomial: expected x after *");
+                }
+            }
+
+            if (p < poly.size() && poly[p] == 'x') {
+                ++p;
+                skip_space();
+                deg = 1;
+
+                if (p < poly.size() && poly[p] == '^') {
+                    ++p;
+                    skip_space();
+                    if (!is_digit()) {
+                        throw std::invalid_argument("fixed_polynomial: bad exponent");
+                    }
+                    deg = number();
+                }
+            } else if (!has_coef) {
+                throw std::invalid_argument("fixed_polynomial: expected a term");
+            }
+
+            if (deg > Degree) {
+                throw std::invalid_argument("fixed_polynomial: exponent above Degree");
+            }
+
+            uint32_t value = static_cast<uint32_t>(coef);
+            res.coefficients[deg] += negative ? 0u - value : value;
+            first = false;
+        }
+
+        if (first) {
+            throw std::invalid_argument("fixed_polynomial: no terms");
+        }
+        return res;
+    }
+
+    template<typename T>
+    constexpr T operator()(const T& base) const {                               // operator()
+        T sum = 0;
+
+#pragma GCC unroll 128
+        for (size_t i = 0; i <= Degree; ++i) {
+            sum = sum * base + static_cast<T>(coefficients[Degree - i]);
+        }
+        return sum;
+    }
+
+    constexpr uint32_t at(size_t pos) const {                                   // at()
+        return pos <= Degree ? coefficients[pos] : 0;
+    }
+
+    polynomial to_polynomial() const {                                          // to_polynomial()
+        polynomial res {};
+
+        for (size_t i = 0; i <= Degree; ++i) {
+            if (coefficients[i] != 0) {
+                res.at(i) = coefficients[i];
+            }
+        }
+        return res;
+    }
+
+    std::array<uint32_t, Degree + 1> coefficients;     // index is the exponent
+};
@@ -1,13 +1,26 @@
 /*
 	SFINAE standard types (de)serialization: 
 	int, double, pair, string, vector, map.
+	Into a byte_buffer / from a buffer_reader, streams go through adapters.
 
 	Ivan Rybin 2020.
 */
 
+#pragma once
+
 #include <iostream>
 #include <cassert>
 #include <sstream>
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <limits>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
 
 template <typename T>
 struct is_pair {
@@ -39,14 +52,38 @@ struct is_map<T, std::void_t<typename T::key_type, typename T::mapped_type>> {
     static constexpr bool value = true;
 };
 
+// contiguous containers of trivially copyable values, one size and one bulk write
+template <typename T>
+struct is_bulk {
+    static constexpr bool value = false;
+};
+
+template <typename V, typename A>
+struct is_bulk<std::vector<V, A>> {
+    static constexpr bool value = std::is_trivially_copyable<V>::value && !std::is_same<V, bool>::value;
+};
+
+template <typename V, size_t N>
+struct is_bulk<std::array<V, N>> {
+    static constexpr bool value = std::is_trivially_copyable<V>::value;
+};
+
+template <typename C, typename Tr, typename A>
+struct is_bulk<std::basic_string<C, Tr, A>> {
+    static constexpr bool value = std::is_trivially_copyable<C>::value;
+};
+
 template <typename T>
-using pod_void = std::enable_if_t<std::is_pod<T>::value, void>;
+using pod_void = std::enable_if_t<std::is_pod<T>::value && !is_bulk<T>::value, void>;
 
 template <typename T>
 using pair_void = std::enable_if_t<is_pair<T>::value, void>;
 
 template <typename T>
-using iter_void = std::enable_if_t<is_container<T>::value && !is_map<T>::value, void>;
+using bulk_void = std::enable_if_t<is_bulk<T>::value, void>;
+
+template <typename T>
+using iter_void = std::enable_if_t<is_container<T>::value && !is_map<T>::value && !is_bulk<T>::value, void>;
 
 template <typename T>
 using map_void = std::enable_if_t<is_container<T>::value && is_map<T>::value, void>;
@@ -54,108 +91,565 @@ using map_void = std::enable_if_t<is_container<T>::value && is_map<T>::value, vo
 template <typename T>
 using bad_void = std::enable_if_t<!is_container<T>::value && !std::is_pod<T>::value && !is_pair<T>::value && !is_map<T>::value, void>;
 
-template <typename T>
-constexpr pod_void<T> serialize(std::ostream& os, T const& obj);
+// writer: write_bytes(data, size), reserve_bytes(size) -> room for size bytes, commit_bytes(used)
+template <typename W, typename = void>
+struct is_writer {
+    static constexpr bool value = false;
+};
 
-template <typename T>
-constexpr pair_void<T> serialize(std::ostream& os, T const& obj);
+template <typename W>
+struct is_writer<W, std::void_t<decltype(std::declval<W&>().write_bytes(std::declval<const char*>(), size_t()))>> {
+    static constexpr bool value = true;
+};
 
-template <typename T>
-constexpr iter_void<T> serialize(std::ostream& os, T const& obj);
+// reader: read_bytes(data, size) -> ok, get_byte() -> byte or -1, fail(), bool
+template <typename R, typename = void>
+struct is_reader {
+    static constexpr bool value = false;
+};
 
-template <typename T>
-constexpr map_void<T> serialize(std::ostream& os, T const& obj);
+template <typename R>
+struct is_reader<R, std::void_t<decltype(std::declval<R&>().read_bytes(std::declval<char*>(), size_t()))>> {
+    static constexpr bool value = true;
+};
 
-template <typename T>
-constexpr bad_void<T> serialize(std::ostream& os, T const& obj);
+template <typename W, typename V = void>
+using if_writer = std::enable_if_t<is_writer<W>::value, V>;
 
-template <typename T>
-constexpr pod_void<T> deserialize(std::ostream& is, T& obj);
+template <typename R, typename V = void>
+using if_reader = std::enable_if_t<is_reader<R>::value, V>;
 
-template <typename T>
-constexpr pair_void<T> deserialize(std::ostream& is, T& obj);
+struct byte_buffer {
+    byte_buffer() = default;
 
-template <typename T>
-constexpr iter_void<T> deserialize(std::ostream& is, T& obj);
+    explicit byte_buffer(size_t capacity) : bytes(capacity) {}
 
-template <typename T>
-constexpr map_void<T> deserialize(std::ostream& is, T& obj);
+    void write_bytes(const char* data, size_t size) {
+        if (size != 0) {
+            std::memcpy(reserve_bytes(size), data, size);
+            used += size;
+        }
+    }
 
-template <typename T>
-constexpr bad_void<T> deserialize(std::ostream& is, T& obj);
+    char* reserve_bytes(size_t size) {                  // the only bounds check, then unchecked writes
+        if (bytes.size() - used < size) {
+            grow(size);
+        }
+        return bytes.data() + used;
+    }
 
-template <typename T>
-constexpr pod_void<T> serialize(std::ostream& os, T const& obj) {
-    size_t size = sizeof(obj);
-    os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
-    os.write(reinterpret_cast<const char*>(&obj), sizeof(obj));
+    void commit_bytes(size_t size) {
+        used += size;
+    }
+
+    const char* data() const { return bytes.data(); }
+    size_t      size() const { return used;         }
+    void        clear()      { used = 0;            }
+
+private:
+    __attribute__((noinline)) void grow(size_t size) {
+        bytes.resize(std::max(bytes.size() * 2, used + size));
+    }
+
+    std::vector<char> bytes = {};                       // capacity, the first used are written
+    size_t            used  = 0;
+};
+
+struct buffer_reader {
+    buffer_reader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+    explicit buffer_reader(const byte_buffer& buf) : buffer_reader(buf.data(), buf.size()) {}
+
+    bool read_bytes(char* data, size_t size) {
+        if (!ok || static_cast<size_t>(end - pos) < size) {
+            ok = false;
+            return false;
+        }
+        if (size != 0) {
+            std::memcpy(data, pos, size);
+            pos += size;
+        }
+        return true;
+    }
+
+    int get_byte() {
+        if (!ok || pos == end) {
+            ok = false;
+            return -1;
+        }
+        return static_cast<unsigned char>(*pos++);
+    }
+
+    void   fail()                     { ok = false; }
+    size_t remaining() const          { return static_cast<size_t>(end - pos); }
+    explicit operator bool() const    { return ok; }
+
+private:
+    const char* pos;
+    const char* end;
+    bool        ok = true;
+};
+
+struct stream_writer {                                  // stages writes in a buffer, flush() hands them to the stream
+    static const size_t buffer_size = size_t(1) << 16;
+
+    explicit stream_writer(std::ostream& os) : os(os), buffer(buffer_size) {}
+
+    void write_bytes(const char* data, size_t size) {
+        if (buffer.size() - used < size) {
+            flush();
+            if (size >= buffer.size()) {                // large blocks go straight through
+                os.write(data, static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        if (size != 0) {
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+    }
+
+    char* reserve_bytes(size_t size) {
+        if (buffer.size() - used < size) {
+            flush();
+            if (buffer.size() < size) {
+                buffer.resize(size);
+            }
+        }
+        return buffer.data() + used;
+    }
+
+    void commit_bytes(size_t size) {
+        used += size;
+    }
+
+    void flush() {
+        if (used != 0) {
+            os.write(buffer.data(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+private:
+    std::ostream&     os;
+    std::vector<char> buffer;
+    size_t            used = 0;
+};
+
+struct stream_reader {                                  // unbuffered, never reads past the value
+    explicit stream_reader(std::istream& is) : is(is) {}
+
+    bool read_bytes(char* data, size_t size) {
+        if (!is) {
+            return false;
+        }
+        if (static_cast<size_t>(is.rdbuf()->sgetn(data, static_cast<std::streamsize>(size))) != size) {
+            is.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+            return false;
+        }
+        return true;
+    }
+
+    int get_byte() {
+        if (!is) {
+            return -1;
+        }
+        int c = is.rdbuf()->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            is.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+            return -1;
+        }
+        return c;
+    }
+
+    void fail()                       { is.setstate(std::ios_base::failbit); }
+    explicit operator bool() const    { return static_cast<bool>(is); }
+
+private:
+    std::istream& is;
+};
+
+enum class wire_format {
+    fixed,                                      // size_t before every value and container, values as in memory
+    compact                                     // LEB128 lengths and integers, signed ones zigzag, no size before values
+};
+
+inline size_t put_varint(uint64_t value, char* out) {   // 7 bits per byte, high bit set on all but the last
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<char>(value);
+    return n;
+}
+
+template <typename W>
+void write_varint(W& out, uint64_t value) {
+    out.commit_bytes(put_varint(value, out.reserve_bytes(10)));
+}
+
+template <typename R>
+bool read_varint(R& in, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int c = in.get_byte();
+        if (c < 0) {
+            return false;
+        }
+        if (shift == 63 && (c & 0x7e) != 0) {           // the 10th byte holds bit 63 only
+            in.fail();
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    in.fail();                                          // longer than 10 bytes
+    return false;
 }
 
 template <typename T>
-constexpr pair_void<T> serialize(std::ostream& os, T const& obj) {
-    serialize(os, obj.first);
-    serialize(os, obj.second);
+uint64_t to_varint(T value) {                           // zigzag for signed: 0, -1, 1, -2 -> 0, 1, 2, 3
+    if constexpr (std::is_signed<T>::value) {
+        int64_t v = static_cast<int64_t>(value);
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    } else {
+        return static_cast<uint64_t>(value);
+    }
 }
 
 template <typename T>
-constexpr iter_void<T> serialize(std::ostream& os, T const& obj) {
+bool from_varint(uint64_t raw, T& value) {              // false if it does not fit T
+    if constexpr (std::is_signed<T>::value) {
+        int64_t v = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) {
+            return false;
+        }
+        value = static_cast<T>(v);
+    } else {
+        if (raw > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+            return false;
+        }
+        value = static_cast<T>(raw);
+    }
+    return true;
+}
+
+template <typename W>
+void write_length(W& out, size_t size, wire_format format) {
+    if (format == wire_format::compact) {
+        write_varint(out, size);
+    } else {
+        out.write_bytes(reinterpret_cast<const char*>(&size), sizeof(size_t));
+    }
+}
+
+template <typename R>
+bool read_length(R& in, size_t& size, wire_format format) {
+    if (format == wire_format::compact) {
+        uint64_t raw = 0;
+        if (!read_varint(in, raw)) {
+            return false;
+        }
+        if (!from_varint(raw, size)) {
+            in.fail();
+            return false;
+        }
+        return true;
+    }
+    return in.read_bytes(reinterpret_cast<char *>(&size), sizeof(size_t));
+}
+
+template <typename W, typename T>
+constexpr if_writer<W, pod_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, pair_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, bulk_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, iter_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, map_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, bad_void<T>> serialize(W& out, T const& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, pod_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, pair_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, bulk_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, iter_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, map_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename R, typename T>
+constexpr if_reader<R, bad_void<T>> deserialize(R& in, T& obj, wire_format format = wire_format::fixed);
+
+template <typename W, typename T>
+constexpr if_writer<W, pod_void<T>> serialize(W& out, T const& obj, wire_format format) {
+    if constexpr (std::is_integral<T>::value) {
+        if (format == wire_format::compact) {
+            write_varint(out, to_varint(obj));
+            return;
+        }
+    }
+    char* dst = out.reserve_bytes(sizeof(size_t) + sizeof(obj));
+    if (format == wire_format::fixed) {
+        size_t size = sizeof(obj);
+        std::memcpy(dst, &size, sizeof(size_t));
+        dst += sizeof(size_t);
+    }
+    std::memcpy(dst, &obj, sizeof(obj));
+    out.commit_bytes((format == wire_format::fixed ? sizeof(size_t) : 0) + sizeof(obj));
+}
+
+template <typename W, typename T>
+constexpr if_writer<W, pair_void<T>> serialize(W& out, T const& obj, wire_format format) {
+    serialize(out, obj.first, format);
+    serialize(out, obj.second, format);
+}
+
+template <typename W, typename T>
+constexpr if_writer<W, bulk_void<T>> serialize(W& out, T const& obj, wire_format format) {
+    using V = typename T::value_type;
+
     size_t size = obj.size();
-    os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
+    write_length(out, size, format);
+
+    if constexpr (std::is_integral<V>::value && sizeof(V) > 1) {
+        if (format == wire_format::compact) {           // one reserve per block of varints
+            const size_t block = 4096;
+
+            for (size_t begin = 0; begin < size; begin += block) {
+                size_t end  = std::min(size, begin + block);
+                char*  dst  = out.reserve_bytes((end - begin) * 10);
+                size_t used = 0;
+
+                for (size_t i = begin; i < end; ++i) {
+                    used += put_varint(to_varint(obj[i]), dst + used);
+                }
+                out.commit_bytes(used);
+            }
+            return;
+        }
+    }
+    out.write_bytes(reinterpret_cast<const char*>(obj.data()), size * sizeof(V));
+}
+
+template <typename W, typename T>
+constexpr if_writer<W, iter_void<T>> serialize(W& out, T const& obj, wire_format format) {
+    write_length(out, obj.size(), format);
     for (const auto& it : obj) {
-        serialize(os, it);
+        serialize(out, it, format);
     }
 }
 
-template <typename T>
-constexpr map_void<T> serialize(std::ostream& os, T const& obj) {
-    size_t size = obj.size();
-    os.write(reinterpret_cast<const char*>(&size), sizeof(size_t));
+template <typename W, typename T>
+constexpr if_writer<W, map_void<T>> serialize(W& out, T const& obj, wire_format format) {
+    write_length(out, obj.size(), format);
     for (const auto& it : obj) {
-        serialize(os, it);
+        serialize(out, it, format);
     }
 }
 
-template <typename T>
-constexpr bad_void<T> serialize(std::ostream& os, T const& obj) {
+template <typename W, typename T>
+constexpr if_writer<W, bad_void<T>> serialize(W& out, T const& obj, wire_format format) {
     static_assert(std::is_pod<T>::value, "Type is not serializable");
 }
 
+template <typename R, typename T>
+constexpr if_reader<R, pod_void<T>> deserialize(R& in, T& obj, wire_format format) {
+    if constexpr (std::is_integral<T>::value) {
+        if (format == wire_format::compact) {
+            uint64_t raw = 0;
+            if (read_varint(in, raw) && !from_varint(raw, obj)) {
+                in.fail();
+            }
+            return;
+        }
+    }
+    if (format == wire_format::fixed) {
+        size_t size = 0;
+        in.read_bytes(reinterpret_cast<char *>(&size), sizeof(size));
+    }
+    in.read_bytes(reinterpret_cast<char *>(&obj), sizeof(obj));
+}
+
+// the stored sizes are untrusted: readers that know what is left check them first,
+// stream readers grow the container a chunk at a time as the bytes arrive
+template <typename R, typename = void>
+struct has_remaining {
+    static constexpr bool value = false;
+};
+
+template <typename R>
+struct has_remaining<R, std::void_t<decltype(std::declval<const R&>().remaining())>> {
+    static constexpr bool value = true;
+};
+
+template <typename R>
+bool fits(R& in, size_t count, size_t min_bytes) {     // false and in failed when count values cannot be left
+    if constexpr (has_remaining<R>::value) {
+        if (count > in.remaining() / min_bytes) {
+            in.fail();
+            return false;
+        }
+    }
+    return true;
+}
+
 template <typename T>
-constexpr pod_void<T> deserialize(std::istream& is, T& obj) {
-    size_t size = 0;
-    is.read(reinterpret_cast<char *>(&size), sizeof(size));
-    is.read(reinterpret_cast<char *>(&obj), sizeof(obj));
+bool bulk_size(const T&, size_t) {                      // vector, string take any size
+    return true;
+}
+
+template <typename V, size_t N>
+bool bulk_size(const std::array<V, N>&, size_t size) {  // array, the size is fixed
+    return size == N;
 }
 
 template <typename T>
-constexpr iter_void<T> deserialize(std::istream& is, T& obj) {
+void bulk_grow(T& obj, size_t size) {
+    obj.resize(size);
+}
+
+template <typename V, size_t N>
+void bulk_grow(std::array<V, N>&, size_t) {}
+
+template <typename R, typename T>
+constexpr if_reader<R, bulk_void<T>> deserialize(R& in, T& obj, wire_format format) {
+    using V = typename T::value_type;
+
+    const bool varints = std::is_integral<V>::value && sizeof(V) > 1 && format == wire_format::compact;
+
     size_t size = 0;
-    is.read(reinterpret_cast<char *>(&size), sizeof(size_t));
-    obj = T(size, typename T::value_type());
-    for (auto& it : obj) {
-        deserialize(is, it);
+    if (!read_length(in, size, format)) {
+        return;
+    }
+    if (!bulk_size(obj, size)) {
+        in.fail();
+        return;
+    }
+    if (!fits(in, size, varints ? 1 : sizeof(V))) {
+        return;
+    }
+
+    const size_t chunk = has_remaining<R>::value ? size : (size_t(1) << 20) / sizeof(V) + 1;
+
+    for (size_t done = 0; done < size;) {                   // doubles, a stream has sent what was allocated
+        size_t step = std::max(chunk, done);
+        size_t next = size - done > step ? done + step : size;
+        bulk_grow(obj, next);
+
+        if constexpr (std::is_integral<V>::value && sizeof(V) > 1) {
+            if (varints) {
+                for (size_t i = done; i < next; ++i) {
+                    uint64_t raw = 0;
+                    if (!read_varint(in, raw)) {
+                        return;
+                    }
+                    if (!from_varint(raw, obj[i])) {
+                        in.fail();
+                        return;
+                    }
+                }
+                done = next;
+                continue;
+            }
+        }
+        if (!in.read_bytes(reinterpret_cast<char *>(&obj[0] + done), (next - done) * sizeof(V))) {
+            return;
+        }
+        done = next;
     }
 }
 
-template <typename T>
-constexpr pair_void<T> deserialize(std::istream& is, T& obj) {
+template <typename R, typename T>
+constexpr if_reader<R, iter_void<T>> deserialize(R& in, T& obj, wire_format format) {
+    using V = typename T::value_type;
+
+    size_t size = 0;
+    if (!read_length(in, size, format) || !fits(in, size, 1)) {     // every value takes a byte at least
+        return;
+    }
+
+    const size_t chunk = has_remaining<R>::value ? size : (size_t(1) << 20) / sizeof(V) + 1;
+
     obj = T();
-    deserialize(is, obj.first);
-    deserialize(is, obj.second);
+    for (size_t done = 0; done < size;) {
+        size_t step = std::max(chunk, done);
+        size_t next = size - done > step ? done + step : size;
+        obj.resize(next);
+
+        for (auto it = std::next(obj.begin(), static_cast<std::ptrdiff_t>(done)); it != obj.end(); ++it) {
+            auto&& ref = *it;
+            if constexpr (std::is_same<decltype(ref), V&>::value) {
+                deserialize(in, ref, format);
+            } else {                                    // proxy reference, vector<bool>
+                V value{};
+                deserialize(in, value, format);
+                ref = value;
+            }
+        }
+        if (!in) {
+            return;
+        }
+        done = next;
+    }
 }
 
-template <typename T>
-constexpr map_void<T> deserialize(std::istream& is, T& obj) {
+template <typename R, typename T>
+constexpr if_reader<R, pair_void<T>> deserialize(R& in, T& obj, wire_format format) {
+    obj = T();
+    deserialize(in, obj.first, format);
+    deserialize(in, obj.second, format);
+}
+
+template <typename R, typename T>
+constexpr if_reader<R, map_void<T>> deserialize(R& in, T& obj, wire_format format) {
     size_t size = 0;
-    is.read(reinterpret_cast<char *>(&size), sizeof(size_t));
+    if (!read_length(in, size, format) || !fits(in, size, 2)) {     // a key and a value, a byte each at least
+        return;
+    }
     std::pair<typename T::key_type, typename T::mapped_type> p;
     for (size_t i = 0; i < size; ++i) {
-        deserialize(is, p);
-        obj.insert(p);
+        deserialize(in, p, format);
+        if (!in) {
+            return;
+        }
+        obj.insert(std::move(p));
     }
 }
 
-template <typename T>
-constexpr bad_void<T> deserialize(std::istream& is, T& obj) {
+template <typename R, typename T>
+constexpr if_reader<R, bad_void<T>> deserialize(R& in, T& obj, wire_format format) {
     static_assert(std::is_pod<T>::value, "Type is not deserializable");
 }
+
+// std::ostream / std::istream adapters
+
+template <typename T>
+void serialize(std::ostream& os, T const& obj, wire_format format = wire_format::fixed) {
+    stream_writer out(os);
+    serialize(out, obj, format);
+    out.flush();
+}
+
+template <typename T>
+void deserialize(std::istream& is, T& obj, wire_format format = wire_format::fixed) {
+    stream_reader in(is);
+    deserialize(in, obj, format);
+}